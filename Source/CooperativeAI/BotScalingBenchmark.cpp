@@ -0,0 +1,362 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CooperativeAI.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Tests/AutomationCommon.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "AI/Navigation/NavigationSystem.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Paths.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFilemanager.h"
+#include "CooperativeAIGameMode.h"
+#include "SBenchmarkTarget.h"
+#include "GameFramework/PlayerController.h"
+
+/**
+ * How many tracker bots one server holds, and what each system costs as the population grows.
+ * Run headless on the benchmark map, which only needs a navmesh floor and the bot spawning game mode blueprint:
+ *   UE4Editor CooperativeAI /Game/Maps/BotBenchmark -game -nullrhi -unattended -ExecCmds="Automation RunTests CooperativeAI.Benchmark.BotScaling;Quit"
+ * -BotBenchmarkMap= picks another map and -BotScalingSteps=20,100,1000 other populations.
+ * Writes one CSV row per population to Saved/Reports/BotScaling-<date>.csv.
+ */
+class FBotScalingBenchmarkCommand : public IAutomationLatentCommand
+{
+public:
+
+	FBotScalingBenchmarkCommand(FAutomationTestBase* InTest, const TArray<int32>& InPopulations)
+		: Test(InTest)
+		, Populations(InPopulations)
+		, Step(EStep::Setup)
+		, PopulationIndex(0)
+		, StepStartTime(0.0)
+		, LastFrameTime(0.0)
+		, MemoryBeforeSpawn(0)
+		, PathQueriesAtStart(0)
+		, PathCacheHitsAtStart(0)
+		, MinBotsMeasured(0)
+	{
+	}
+
+	virtual bool Update() override;
+
+protected:
+
+	enum class EStep : uint8
+	{
+		Setup,
+
+		Spawning,
+
+		Warmup,
+
+		Measure,
+
+		Done,
+	};
+
+	UWorld* GetWorld() const;
+
+	void SpawnTargets(UWorld* World);
+
+	// The players' own pawns would draw bots off the targets, the targets are the only players left
+	void RemovePlayerPawns(UWorld* World);
+
+	void WriteRow(ACooperativeAIGameMode* GameMode, int32 Population);
+
+	// Seconds the population runs before and while being measured, and the most spawning may take
+	static constexpr double WarmupSeconds = 3.0;
+	static constexpr double MeasureSeconds = 10.0;
+	static constexpr double SpawnTimeoutSeconds = 180.0;
+
+	// Stationary targets the bots hunt, spread around the map's origin
+	static constexpr int32 NumTargets = 4;
+	static constexpr float TargetRingRadius = 1500.0f;
+
+	FAutomationTestBase* Test;
+
+	TArray<int32> Populations;
+
+	EStep Step;
+
+	int32 PopulationIndex;
+
+	double StepStartTime;
+
+	double LastFrameTime;
+
+	// Wall clock time of each measured frame, in milliseconds
+	TArray<float> FrameTimes;
+
+	uint64 MemoryBeforeSpawn;
+
+	int32 PathQueriesAtStart;
+
+	int32 PathCacheHitsAtStart;
+
+	// Fewest bots alive in a measured frame, the row only describes the population if none were lost
+	int32 MinBotsMeasured;
+
+	FString FileName;
+};
+
+
+bool FBotScalingBenchmarkCommand::Update()
+{
+	UWorld* World = GetWorld();
+	ACooperativeAIGameMode* GameMode = World ? Cast<ACooperativeAIGameMode>(World->GetAuthGameMode()) : nullptr;
+	if (!GameMode)
+	{
+		Test->AddError(TEXT("The benchmark map has no CooperativeAI game mode"));
+		return true;
+	}
+
+	const double Now = FPlatformTime::Seconds();
+
+	switch (Step)
+	{
+	case EStep::Setup:
+	{
+		if (PopulationIndex >= Populations.Num())
+		{
+			Step = EStep::Done;
+			return true;
+		}
+
+		if (PopulationIndex == 0)
+		{
+			SpawnTargets(World);
+			RemovePlayerPawns(World);
+		}
+
+		const int32 Population = Populations[PopulationIndex];
+		GameMode->DestroyAllBots();
+		GameMode->SetBotPopulation(Population, Population);
+
+		// The last step's bots are gone from memory before the baseline is taken
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+		GameMode->SetSpawnRate(64, 4000.0f);
+
+		MemoryBeforeSpawn = FPlatformMemory::GetStats().UsedPhysical;
+		GameMode->StartBenchmarkWave();
+
+		Step = EStep::Spawning;
+		StepStartTime = Now;
+		return false;
+	}
+
+	case EStep::Spawning:
+		if (GameMode->GetBotRegistry().Num() >= Populations[PopulationIndex])
+		{
+			Step = EStep::Warmup;
+			StepStartTime = Now;
+		}
+		else if (Now - StepStartTime > SpawnTimeoutSeconds)
+		{
+			Test->AddWarning(FString::Printf(TEXT("Only %d of %d bots spawned, measuring anyway"), GameMode->GetBotRegistry().Num(), Populations[PopulationIndex]));
+			Step = EStep::Warmup;
+			StepStartTime = Now;
+		}
+		return false;
+
+	case EStep::Warmup:
+		if (Now - StepStartTime >= WarmupSeconds)
+		{
+			FCoopScopeTimes::Reset();
+			FrameTimes.Reset();
+			PathQueriesAtStart = GameMode->GetPathQueue().GetNumQueriesStarted();
+			PathCacheHitsAtStart = GameMode->GetPathQueue().GetCacheHits();
+			Step = EStep::Measure;
+			StepStartTime = Now;
+			LastFrameTime = Now;
+			MinBotsMeasured = GameMode->GetBotRegistry().Num();
+		}
+		return false;
+
+	case EStep::Measure:
+		FrameTimes.Add((float)((Now - LastFrameTime) * 1000.0));
+		LastFrameTime = Now;
+		MinBotsMeasured = FMath::Min(MinBotsMeasured, GameMode->GetBotRegistry().Num());
+
+		if (Now - StepStartTime >= MeasureSeconds)
+		{
+			WriteRow(GameMode, Populations[PopulationIndex]);
+
+			PopulationIndex++;
+			Step = EStep::Setup;
+		}
+		return false;
+
+	default:
+		return true;
+	}
+}
+
+
+UWorld* FBotScalingBenchmarkCommand::GetWorld() const
+{
+	for (const FWorldContext& Context : GEngine->GetWorldContexts())
+	{
+		if ((Context.WorldType == EWorldType::Game || Context.WorldType == EWorldType::PIE) && Context.World())
+		{
+			return Context.World();
+		}
+	}
+	return nullptr;
+}
+
+
+void FBotScalingBenchmarkCommand::SpawnTargets(UWorld* World)
+{
+	// The map may place its own
+	if (TActorIterator<ASBenchmarkTarget>(World))
+	{
+		return;
+	}
+
+	UNavigationSystem* NavSys = World->GetNavigationSystem();
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+	for (int32 TargetIndex = 0; TargetIndex < NumTargets; TargetIndex++)
+	{
+		FVector Location = FRotator(0.0f, 360.0f * TargetIndex / NumTargets, 0.0f).Vector() * TargetRingRadius;
+
+		FNavLocation NavLocation;
+		if (NavSys && NavSys->ProjectPointToNavigation(Location, NavLocation, FVector(500.0f, 500.0f, 5000.0f)))
+		{
+			Location = NavLocation.Location + FVector(0.0f, 0.0f, 100.0f);
+		}
+
+		World->SpawnActor<ASBenchmarkTarget>(ASBenchmarkTarget::StaticClass(), Location, FRotator::ZeroRotator, SpawnParams);
+	}
+}
+
+
+void FBotScalingBenchmarkCommand::RemovePlayerPawns(UWorld* World)
+{
+	for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+	{
+		APlayerController* PC = It->Get();
+		APawn* PlayerPawn = PC ? PC->GetPawn() : nullptr;
+		if (PlayerPawn)
+		{
+			PC->UnPossess();
+			PlayerPawn->Destroy();
+		}
+	}
+}
+
+
+void FBotScalingBenchmarkCommand::WriteRow(ACooperativeAIGameMode* GameMode, int32 Population)
+{
+	const int32 NumBots = GameMode->GetBotRegistry().Num();
+	if (MinBotsMeasured < Population)
+	{
+		Test->AddWarning(FString::Printf(TEXT("The population of %d fell to %d bots while measuring, bots exploded or spawning fell short"), Population, MinBotsMeasured));
+	}
+
+	const int32 NumFrames = FMath::Max(FrameTimes.Num(), 1);
+
+	TArray<float> SortedFrameTimes = FrameTimes;
+	SortedFrameTimes.Sort();
+	auto GetPercentile = [&SortedFrameTimes](float Percentile)
+	{
+		if (SortedFrameTimes.Num() == 0)
+		{
+			return 0.0f;
+		}
+		const int32 Rank = FMath::CeilToInt(Percentile * SortedFrameTimes.Num());
+		return SortedFrameTimes[FMath::Clamp(Rank - 1, 0, SortedFrameTimes.Num() - 1)];
+	};
+
+	float TotalMs = 0.0f;
+	for (float FrameTime : FrameTimes)
+	{
+		TotalMs += FrameTime;
+	}
+	const float AverageMs = TotalMs / NumFrames;
+
+	const uint64 MemoryAfterSpawn = FPlatformMemory::GetStats().UsedPhysical;
+	const double MemoryPerBotKB = NumBots > 0 && MemoryAfterSpawn > MemoryBeforeSpawn ? (MemoryAfterSpawn - MemoryBeforeSpawn) / 1024.0 / NumBots : 0.0;
+	const float PathQueriesPerSecond = (GameMode->GetPathQueue().GetNumQueriesStarted() - PathQueriesAtStart) / (float)MeasureSeconds;
+	const float PathCacheHitsPerSecond = (GameMode->GetPathQueue().GetCacheHits() - PathCacheHitsAtStart) / (float)MeasureSeconds;
+
+	const bool bNewFile = FileName.IsEmpty();
+	if (bNewFile)
+	{
+		FileName = FPaths::ProjectSavedDir() / TEXT("Reports") / FString::Printf(TEXT("BotScaling-%s.csv"), *FDateTime::Now().ToString());
+		FPlatformFileManager::Get().GetPlatformFile().CreateDirectoryTree(*FPaths::GetPath(FileName));
+	}
+
+	FString Row;
+	if (bNewFile)
+	{
+		Row += TEXT("Population,Bots,MinBots,Frames,AvgMs,P50Ms,P95Ms,P99Ms,Hz,PathQueriesPerSecond,PathCacheHitsPerSecond,MemoryPerBotKB");
+		for (int32 Scope = 0; Scope < (int32)ECoopScope::Count; Scope++)
+		{
+			Row += FString::Printf(TEXT(",%sMsPerFrame"), FCoopScopeTimes::GetName((ECoopScope)Scope));
+		}
+		Row += LINE_TERMINATOR;
+	}
+
+	Row += FString::Printf(TEXT("%d,%d,%d,%d,%.3f,%.3f,%.3f,%.3f,%.1f,%.1f,%.1f,%.2f"), Population, NumBots, MinBotsMeasured, FrameTimes.Num(), AverageMs,
+		GetPercentile(0.5f), GetPercentile(0.95f), GetPercentile(0.99f), AverageMs > 0.0f ? 1000.0f / AverageMs : 0.0f,
+		PathQueriesPerSecond, PathCacheHitsPerSecond, MemoryPerBotKB);
+	for (int32 Scope = 0; Scope < (int32)ECoopScope::Count; Scope++)
+	{
+		Row += FString::Printf(TEXT(",%.4f"), FPlatformTime::ToMilliseconds64(FCoopScopeTimes::Cycles[Scope]) / NumFrames);
+	}
+	Row += LINE_TERMINATOR;
+
+	FFileHelper::SaveStringToFile(Row, *FileName, FFileHelper::EEncodingOptions::ForceAnsi, &IFileManager::Get(), FILEWRITE_Append);
+
+	Test->AddInfo(FString::Printf(TEXT("%d bots: %.2f ms per frame (%.1f Hz), p99 %.2f ms"), NumBots, AverageMs,
+		AverageMs > 0.0f ? 1000.0f / AverageMs : 0.0f, GetPercentile(0.99f)));
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBotScalingBenchmarkTest, "CooperativeAI.Benchmark.BotScaling",
+	EAutomationTestFlags::ClientContext | EAutomationTestFlags::ServerContext | EAutomationTestFlags::PerfFilter)
+
+bool FBotScalingBenchmarkTest::RunTest(const FString& Parameters)
+{
+	FString MapName = TEXT("/Game/Maps/BotBenchmark");
+	FParse::Value(FCommandLine::Get(), TEXT("BotBenchmarkMap="), MapName);
+
+	TArray<int32> Populations;
+	FString Steps;
+	if (FParse::Value(FCommandLine::Get(), TEXT("BotScalingSteps="), Steps, false))
+	{
+		TArray<FString> StepNames;
+		Steps.ParseIntoArray(StepNames, TEXT(","));
+		for (const FString& StepName : StepNames)
+		{
+			const int32 Population = FCString::Atoi(*StepName);
+			if (Population > 0)
+			{
+				Populations.Add(Population);
+			}
+		}
+	}
+	if (Populations.Num() == 0)
+	{
+		Populations = { 20, 50, 100, 250, 500, 1000, 2000, 4000 };
+	}
+
+	ADD_LATENT_AUTOMATION_COMMAND(FLoadGameMapCommand(MapName));
+	ADD_LATENT_AUTOMATION_COMMAND(FWaitForMapToLoadCommand());
+	ADD_LATENT_AUTOMATION_COMMAND(FBotScalingBenchmarkCommand(this, Populations));
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
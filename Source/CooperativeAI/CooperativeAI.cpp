@@ -4,4 +4,47 @@
 #include "Modules/ModuleManager.h"
 
 IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, CooperativeAI, "CooperativeAI" );
- 
\ No newline at end of file
+
+uint64 FCoopScopeTimes::Cycles[(uint8)ECoopScope::Count];
+uint32 FCoopScopeTimes::Calls[(uint8)ECoopScope::Count];
+FCoopScopeTimer* FCoopScopeTimer::Current = nullptr;
+
+
+void FCoopScopeTimes::Reset()
+{
+	for (int32 Scope = 0; Scope < (int32)ECoopScope::Count; Scope++)
+	{
+		Cycles[Scope] = 0;
+		Calls[Scope] = 0;
+	}
+}
+
+
+const TCHAR* FCoopScopeTimes::GetName(ECoopScope Scope)
+{
+	switch (Scope)
+	{
+	case ECoopScope::Swarm:
+		return TEXT("Swarm");
+	case ECoopScope::PathQueue:
+		return TEXT("PathQueue");
+	case ECoopScope::PathQuery:
+		return TEXT("PathQuery");
+	case ECoopScope::FlowFields:
+		return TEXT("FlowFields");
+	case ECoopScope::Significance:
+		return TEXT("Significance");
+	case ECoopScope::Proximity:
+		return TEXT("Proximity");
+	case ECoopScope::Movement:
+		return TEXT("Movement");
+	case ECoopScope::WeaponTraces:
+		return TEXT("WeaponTraces");
+	case ECoopScope::Spawning:
+		return TEXT("Spawning");
+	case ECoopScope::Explosions:
+		return TEXT("Explosions");
+	default:
+		return TEXT("Unknown");
+	}
+}
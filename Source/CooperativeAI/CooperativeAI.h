@@ -3,3 +3,91 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Stats/Stats.h"
+
+// Stats of the game code, shown with "stat COOP"
+DECLARE_STATS_GROUP(TEXT("COOP"), STATGROUP_COOP, STATCAT_Advanced);
+
+// Game code scopes timed for the per-wave frame report, next to their COOP stat.
+// Exclusive: a scope entered inside another, like PathQuery inside PathQueue, is not counted in the outer one, so the columns add up
+enum class ECoopScope : uint8
+{
+	Swarm,
+
+	PathQueue,
+
+	PathQuery,
+
+	FlowFields,
+
+	Significance,
+
+	Proximity,
+
+	Movement,
+
+	WeaponTraces,
+
+	Spawning,
+
+	Explosions,
+
+	Count,
+};
+
+// Game thread cycles spent in each scope since the last reset. Unlike the stats, they are readable by the game in shipping builds
+struct FCoopScopeTimes
+{
+	static uint64 Cycles[(uint8)ECoopScope::Count];
+
+	static uint32 Calls[(uint8)ECoopScope::Count];
+
+	static void Reset();
+
+	static const TCHAR* GetName(ECoopScope Scope);
+};
+
+// Adds the time until the end of the enclosing block to the scope's entry, game thread only.
+// The enclosing timer is paused meanwhile
+struct FCoopScopeTimer
+{
+	FCoopScopeTimer(ECoopScope InScope)
+		: Scope((uint8)InScope)
+		, StartCycles(FPlatformTime::Cycles64())
+		, Parent(Current)
+	{
+		if (Parent)
+		{
+			FCoopScopeTimes::Cycles[Parent->Scope] += StartCycles - Parent->StartCycles;
+		}
+		Current = this;
+	}
+
+	~FCoopScopeTimer()
+	{
+		const uint64 EndCycles = FPlatformTime::Cycles64();
+		FCoopScopeTimes::Cycles[Scope] += EndCycles - StartCycles;
+		FCoopScopeTimes::Calls[Scope]++;
+
+		if (Parent)
+		{
+			Parent->StartCycles = EndCycles;
+		}
+		Current = Parent;
+	}
+
+	uint8 Scope;
+
+	// Start of the part not yet added, moved on when a nested scope ends
+	uint64 StartCycles;
+
+	FCoopScopeTimer* Parent;
+
+	// Innermost running timer
+	static FCoopScopeTimer* Current;
+};
+
+// Cycle stat and wave report time for the rest of the block
+#define COOP_SCOPE_CYCLE_COUNTER(Stat, Scope) \
+	SCOPE_CYCLE_COUNTER(Stat); \
+	FCoopScopeTimer PREPROCESSOR_JOIN(CoopScopeTimer, __LINE__)(ECoopScope::Scope)
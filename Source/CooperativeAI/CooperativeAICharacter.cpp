@@ -10,6 +10,7 @@
 #include "GameFramework/Controller.h"
 #include "GameFramework/SpringArmComponent.h"
 #include "SWeapon.h"
+#include "CooperativeAIGameMode.h"
 
 //////////////////////////////////////////////////////////////////////////
 // ACooperativeAICharacter
@@ -77,6 +78,39 @@ void ACooperativeAICharacter::BeginPlay()
 	}
 }
 
+void ACooperativeAICharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	ACooperativeAIGameMode* MyGameMode = Cast<ACooperativeAIGameMode>(GetWorld()->GetAuthGameMode());
+	if (MyGameMode)
+	{
+		MyGameMode->NotifyPlayerDied(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void ACooperativeAICharacter::PossessedBy(AController* NewController)
+{
+	Super::PossessedBy(NewController);
+
+	ACooperativeAIGameMode* MyGameMode = Cast<ACooperativeAIGameMode>(GetWorld()->GetAuthGameMode());
+	if (MyGameMode && !bDied && Cast<APlayerController>(NewController))
+	{
+		MyGameMode->NotifyPlayerAlive(this);
+	}
+}
+
+void ACooperativeAICharacter::UnPossessed()
+{
+	ACooperativeAIGameMode* MyGameMode = Cast<ACooperativeAIGameMode>(GetWorld()->GetAuthGameMode());
+	if (MyGameMode)
+	{
+		MyGameMode->NotifyPlayerDied(this);
+	}
+
+	Super::UnPossessed();
+}
+
 void ACooperativeAICharacter::OnHealthChanged(USHealthComponent* OwningHealthComp, float Health, float HealthDelta, const class UDamageType* DamageType,
 	class AController* InstigatedBy, AActor* DamageCauser)
 {
@@ -85,6 +119,12 @@ void ACooperativeAICharacter::OnHealthChanged(USHealthComponent* OwningHealthCom
 		// Die!
 		bDied = true;
 
+		ACooperativeAIGameMode* MyGameMode = Cast<ACooperativeAIGameMode>(GetWorld()->GetAuthGameMode());
+		if (MyGameMode)
+		{
+			MyGameMode->NotifyPlayerDied(this);
+		}
+
 		GetMovementComponent()->StopMovementImmediately();
 		GetCapsuleComponent()->SetCollisionEnabled(ECollisionEnabled::NoCollision);
 
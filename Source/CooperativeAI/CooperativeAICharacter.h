@@ -56,6 +56,13 @@ protected:
 
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	// Keep the game mode's alive player count in sync with who controls this pawn
+	virtual void PossessedBy(AController* NewController) override;
+
+	virtual void UnPossessed() override;
+
 	void BeginCrouch();
 
 	void EndCrouch();
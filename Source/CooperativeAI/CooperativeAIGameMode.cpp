@@ -1,6 +1,7 @@
 // Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
 
 #include "CooperativeAIGameMode.h"
+#include "CooperativeAI.h"
 #include "CooperativeAICharacter.h"
 #include "STrackerBot.h"
 #include "SHealthComponent.h"
@@ -11,6 +12,27 @@
 #include "UObject/ConstructorHelpers.h"
 #include "Kismet/GameplayStatics.h"
 #include "Engine/World.h"
+#include "EnvironmentQuery/EnvQuery.h"
+#include "EnvironmentQuery/EnvQueryManager.h"
+
+static int32 ForceKinematicBots = 0;
+FAutoConsoleVariableRef CVARForceKinematicBots(
+	TEXT("COOP.KinematicBots"),
+	ForceKinematicBots,
+	TEXT("Move every tracker bot kinematically from the next wave on"),
+	ECVF_Cheat);
+
+static int32 UseFlowFields = 1;
+FAutoConsoleVariableRef CVARUseFlowFields(
+	TEXT("COOP.FlowFields"),
+	UseFlowFields,
+	TEXT("Move TrackerBots along shared per player flow fields, 0 uses a path query for every step"),
+	ECVF_Cheat);
+
+DECLARE_CYCLE_STAT(TEXT("Spawn Scheduler"), STAT_SpawnScheduler, STATGROUP_COOP);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Bot Spawn Queue"), STAT_BotSpawnQueue, STATGROUP_COOP);
+DECLARE_CYCLE_STAT(TEXT("Swarm Update"), STAT_SwarmUpdate, STATGROUP_COOP);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Bots Alive"), STAT_BotsAlive, STATGROUP_COOP);
 
 ACooperativeAIGameMode::ACooperativeAIGameMode()
 {
@@ -20,44 +42,124 @@ ACooperativeAIGameMode::ACooperativeAIGameMode()
 		DefaultPawnClass = PlayerPawnBPClass.Class;
 	}
 	
+	static ConstructorHelpers::FClassFinder<ASTrackerBot> TrackerBotBPClass(TEXT("/Game/TrackerBot/BP_TrackerBot"));
+	if (TrackerBotBPClass.Class != NULL)
+	{
+		PooledBotClass = TrackerBotBPClass.Class;
+	}
+
+	static ConstructorHelpers::FObjectFinder<UEnvQuery> SpawnQuery(TEXT("/Game/Blueprints/EQS_FindSpawnLocation"));
+	BotSpawnQuery = SpawnQuery.Object;
+	
 	TimeBetweenWaves = 30.0f;
 
 	GameStateClass = ASGameState::StaticClass();
 	PlayerStateClass = ASPlayerState::StaticClass();
 
 	PrimaryActorTick.bCanEverTick = true;
-	PrimaryActorTick.TickInterval = 1.0f;
+	// Every frame, the spawn scheduler runs from Tick
+	PrimaryActorTick.TickInterval = 0.0f;
+
+	bSpawningBots = false;
+	MaxBotSpawnsPerFrame = 2;
+	SpawnBudgetMicroseconds = 500.0f;
+	PathBudgetMicroseconds = 500.0f;
+
+	BotPoolSize = BOTS;
+	BotsPerWave = BOTS;
+	MaxBotPopulation = BOTS * 3;
+	bKinematicBots = false;
+	WaveNumber = 0;
+	bBenchmarkMode = false;
+	WavePathQueriesAtStart = 0;
+	WavePathCacheHitsAtStart = 0;
+	KinematicLODTier = (int32)ETrackerBotLOD::Count;
+	bPrewarmingBotPool = false;
+	bAcquiringBots = false;
+
+	NumAttackAngles = BOTS;
+	SwarmSeed = 0;
+	NextSubSwarm = 0;
+}
 
-	BestGlobalAngle = 0.0f;
+void ACooperativeAIGameMode::InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage)
+{
+	Super::InitGame(MapName, Options, ErrorMessage);
 
-	// Initializing the data structures
-	float AttackAnglesAroundPlayer = 360 / BOTS;
-	float Angle = 0.0f;
-	for (int i = 0; i < BOTS; i++, Angle += AttackAnglesAroundPlayer) {
-		PossibleAttackAngles.Add(Angle);
-		LocalAttackAngles.Add(Angle);
-		AnglesDamaged.Add(Angle, false);
-		PheromoneQuantities.Add(Angle, 1.0f); // Pheromone set initially to 1.0 to avoid division by zero in selection probabilities
-		HitAngles.Add(Angle, 0.0f);
+	SwarmSeed = UGameplayStatics::GetIntOption(Options, TEXT("SwarmSeed"), SwarmSeed);
+	if (SwarmSeed == 0)
+	{
+		SwarmSeed = (int32)(FPlatformTime::Cycles() | 1);
 	}
+
+	SwarmOptimizer.SetSeed((uint32)SwarmSeed);
+
+	FString Modes = UGameplayStatics::ParseOption(Options, TEXT("SwarmModes"));
+	if (!Modes.IsEmpty())
+	{
+		SetSubSwarmModes(Modes);
+	}
+
+	BotsPerWave = FMath::Max(1, UGameplayStatics::GetIntOption(Options, TEXT("Bots"), BotsPerWave));
+	MaxBotPopulation = FMath::Max(1, UGameplayStatics::GetIntOption(Options, TEXT("MaxBots"), FMath::Max(MaxBotPopulation, BotsPerWave * 3)));
+
+	UE_LOG(LogTemp, Log, TEXT("Swarm seed: %d"), SwarmSeed);
 }
 
 void ACooperativeAIGameMode::BeginPlay()
 {
 	Super::BeginPlay();
 
+	for (int32 Tier = 0; Tier < (int32)ETrackerBotLOD::Count; Tier++)
+	{
+		Significance.Tiers[Tier].bKinematic = Tier >= KinematicLODTier;
+	}
+
 	/*APlayerController* localPlayer2 = UGameplayStatics::CreatePlayer(GetWorld(), -1, true);
 	APlayerController* localPlayer3 = UGameplayStatics::CreatePlayer(GetWorld(), -1, true);
 	APlayerController* localPlayer4 = UGameplayStatics::CreatePlayer(GetWorld(), -1, true);*/
 
 }
 
+void ACooperativeAIGameMode::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// Before the path queue forgets its counts
+	FinishWaveReport();
+
+	BotRegistry.Reset();
+	AlivePlayers.Reset();
+	AlivePlayerHealthComps.Reset();
+	TeamRegistry.Reset();
+	PathQueue.Reset();
+	FlowFields.Reset();
+	Significance.Reset();
+	Movement.Reset();
+	Proximity.Reset();
+	Explosions.Reset();
+	DamageTelemetry.Shutdown();
+	WaveReport.Reset();
+	BotPool.Reset();
+
+	Super::EndPlay(EndPlayReason);
+}
+
 
 void ACooperativeAIGameMode::StartWave()
 {
-	NrOfBotsToSpawn = BOTS;
+	NrOfBotsToSpawn = BotsPerWave;
+	bPrewarmingBotPool = false;
 
-	GetWorldTimerManager().SetTimer(TimerHandle_BotSpawner, this, &ACooperativeAIGameMode::SpawnBotTimerElapsed, 0.01f, true, 5.0f);
+	// The previous wave's row covers its fight up to now
+	FinishWaveReport();
+	WaveNumber++;
+	WaveReport.BeginWave(WaveNumber);
+	WavePathQueriesAtStart = PathQueue.GetNumQueriesStarted();
+	WavePathCacheHitsAtStart = PathQueue.GetCacheHits();
+
+	// Switched per wave, the bots change mode at the next significance pass
+	Significance.bForceKinematic = bKinematicBots || ForceKinematicBots > 0;
+
+	GetWorldTimerManager().SetTimer(TimerHandle_BotSpawner, this, &ACooperativeAIGameMode::StartSpawningBots, 5.0f, false);
 
 	SetWaveState(EWaveState::WaveInProgress);
 
@@ -67,202 +169,192 @@ void ACooperativeAIGameMode::StartWave()
 void ACooperativeAIGameMode::EndWave()
 {
 	GetWorldTimerManager().ClearTimer(TimerHandle_BotSpawner);
+	bSpawningBots = false;
 
-	// Diffusion phase, the non damaging bots seek new hypothesis for themselves in SDS
-	if (bStochasticMode) {
-		StochasticDiffusionSearch();
-	}
-
-	// Ant selection of solution and deposit/evaporation of pheromones
-	else if (bAntColonyMode) {
-		AntColonyOptimization();
-	}
-
-	else if (bParticleSwarmMode) {
-		ParticleSwarmOptimization();
-	}
-
-	
+	UpdateSwarm();
 
 	PrepareForNextWave();
 }
 
 
-void ACooperativeAIGameMode::StochasticDiffusionSearch() {
-
-	//  Set random hypothesis to the newly spawned bots
-	int Random;
-	for (TActorIterator<ASTrackerBot> ActorItr(GetWorld()); ActorItr; ++ActorItr)
-	{
-		Random = (rand() % static_cast<int>((BOTS - 1) - 1));
-		if (ActorItr->AttackAngle == 0.0f) {
-			ActorItr->AttackAngle = PossibleAttackAngles[Random];
-		}
-	}
-
-	// Check if hypothesis has damaged players and if not select another at random up to twice
-	for (TActorIterator<ASTrackerBot> ActorItr(GetWorld()); ActorItr; ++ActorItr)
+void ACooperativeAIGameMode::FinishWaveReport()
+{
+	if (WaveReport.IsRecording())
 	{
-		if (AnglesDamaged[ActorItr->AttackAngle]) {
-			continue;
-		}
-		else {
-			Random = (rand() % static_cast<int>((NrOfBotsToSpawn - 1) - 1));
-
-			if (AnglesDamaged[PossibleAttackAngles[Random]]) {
-				ActorItr->AttackAngle = PossibleAttackAngles[Random];
-			}
-			else {
-				Random = (rand() % static_cast<int>((NrOfBotsToSpawn - 1) - 1));
-				ActorItr->AttackAngle = PossibleAttackAngles[Random];
-			}
-		}
+		WaveReport.EndWave(PathQueue.GetNumQueriesStarted() - WavePathQueriesAtStart, PathQueue.GetCacheHits() - WavePathCacheHitsAtStart);
 	}
 }
 
-void ACooperativeAIGameMode::AntColonyOptimization() {
-	
-	float Random;
-	float TotalPheromones = 0.0f;
 
-	//  Set random hypothesis to the newly spawned bots (will be changed by the algorithm)
-	for (TActorIterator<ASTrackerBot> ActorItr(GetWorld()); ActorItr; ++ActorItr)
+void ACooperativeAIGameMode::UpdateSwarm()
+{
+	const int32 NumSubSwarms = SwarmOptimizer.GetNumSubSwarms();
+	if (NumSubSwarms == 0)
 	{
-		Random = (rand() % static_cast<int>((BOTS - 1) - 1));
-		if (ActorItr->AttackAngle == 0.0f) {
-			ActorItr->AttackAngle = PossibleAttackAngles[Random];
-		}
+		return;
 	}
 
-	// Evaporation and deposit of pheromones
-	for (auto Itr = PheromoneQuantities.CreateIterator(); Itr; ++Itr)
-	{
-		PheromoneQuantities.Add(Itr.Key(), (1 - EVAPORATION_RATE) * Itr.Value());
+	// Snapshot of the bots, every sub-swarm gets its own batch so each strategy only sees its own bots
+	TArray<TArray<ASTrackerBot*>> Bots;
+	TArray<FSwarmBotBatch> SwarmBots;
+	Bots.SetNum(NumSubSwarms);
+	SwarmBots.SetNum(NumSubSwarms);
 
-		if (AnglesDamaged[Itr.Key()]) {
-			PheromoneQuantities[Itr.Key()] += 1.0f;
+	for (ASTrackerBot* Bot : BotRegistry.GetBots())
+	{
+		if (Bot->SubSwarmIndex < 0 || Bot->SubSwarmIndex >= NumSubSwarms)
+		{
+			Bot->SubSwarmIndex = NextSubSwarm;
+			NextSubSwarm = (NextSubSwarm + 1) % NumSubSwarms;
 		}
 
-		TotalPheromones += Itr.Value();
+		Bots[Bot->SubSwarmIndex].Add(Bot);
+		SwarmBots[Bot->SubSwarmIndex].Add(Bot->AttackAngle, Bot->BestLocalAngle);
 	}
 
-	// Selection
+	UE_LOG(LogTemp, Log, TEXT("Bots: %d alive, %d exploding, %d dead. LOD: %d near, %d mid, %d far. Path cache: %d hits, %d misses"),
+		BotRegistry.GetNumAlive(), BotRegistry.GetNumExploding(), BotRegistry.GetNumDead(),
+		Significance.GetNumInTier(ETrackerBotLOD::Near), Significance.GetNumInTier(ETrackerBotLOD::Mid), Significance.GetNumInTier(ETrackerBotLOD::Far),
+		PathQueue.GetCacheHits(), PathQueue.GetCacheMisses());
 
-	// <AttackAngle, Pheromones as a percentage of total pheromones>
-	TMap<float, float> SelectionProbability;
-	for (auto Itr = PheromoneQuantities.CreateIterator(); Itr; ++Itr)
+	// The strategies only work on the snapshot, the per bot steps run on the worker threads
+	for (int32 SubSwarmIndex = 0; SubSwarmIndex < NumSubSwarms; SubSwarmIndex++)
 	{
-		SelectionProbability.Add(Itr.Key(), (Itr.Value() / TotalPheromones));
+		const FSwarmSubSwarm& SubSwarm = SwarmOptimizer.GetSubSwarm(SubSwarmIndex);
+		UE_LOG(LogTemp, Log, TEXT("Sub-swarm %d (%s): %d bots, wave hit rate %.2f (%d/%d), match hit rate %.2f"),
+			SubSwarmIndex, GetSwarmStrategyName(SubSwarm.Strategy), Bots[SubSwarmIndex].Num(),
+			SubSwarm.GetWaveHitRate(), SubSwarm.WaveHits, SubSwarm.WaveHits + SubSwarm.WaveMisses, SubSwarm.GetTotalHitRate());
+
+		COOP_SCOPE_CYCLE_COUNTER(STAT_SwarmUpdate, Swarm);
+		SwarmOptimizer.Update(SubSwarmIndex, SwarmBots[SubSwarmIndex]);
 	}
 
-	for (TActorIterator<ASTrackerBot> ActorItr(GetWorld()); ActorItr; ++ActorItr)
+	// Back on the game thread, hand the new angles to the bots
+	for (int32 SubSwarmIndex = 0; SubSwarmIndex < NumSubSwarms; SubSwarmIndex++)
 	{
-		float GeneratedProbability = 0.0f, PreviousProbability = 0.0f;
-		Random = static_cast <float> (rand()) / (static_cast <float> (RAND_MAX / 1.0f));
-		for (auto Itr = SelectionProbability.CreateIterator(); Itr; ++Itr)
+		for (int32 BotIndex = 0; BotIndex < Bots[SubSwarmIndex].Num(); BotIndex++)
 		{
-			GeneratedProbability += Itr.Value();
-			if (Random < GeneratedProbability && Random > PreviousProbability) {
-				ActorItr->AttackAngle = Itr.Key();
-				break;
-			}
-			PreviousProbability = GeneratedProbability;
+			Bots[SubSwarmIndex][BotIndex]->AttackAngle = SwarmBots[SubSwarmIndex].AttackAngles[BotIndex];
+			Bots[SubSwarmIndex][BotIndex]->BestLocalAngle = SwarmBots[SubSwarmIndex].BestLocalAngles[BotIndex];
 		}
 	}
 }
 
-void ACooperativeAIGameMode::ParticleSwarmOptimization() {
 
-	float Random;
+void ACooperativeAIGameMode::SetSwarmStrategies(const TArray<ESwarmStrategy>& Strategies)
+{
+	SwarmStrategies = Strategies;
+	NextSubSwarm = 0;
+
+	SwarmOptimizer.Initialize(FMath::Max(NumAttackAngles, 3), SwarmStrategies);
+	PathQueue.NumAngleBuckets = SwarmOptimizer.GetNumAngles();
+}
 
-	//  Set random hypothesis to the newly spawned bots (will be changed by the algorithm)
-	for (TActorIterator<ASTrackerBot> ActorItr(GetWorld()); ActorItr; ++ActorItr)
-	{
-		Random = (rand() % static_cast<int>((BOTS - 1) - 1));
-		if (ActorItr->AttackAngle == 0.0f) {
-			ActorItr->AttackAngle = PossibleAttackAngles[Random];
-		}
 
-		Random = (rand() % static_cast<int>((NrOfBotsToSpawn - 1) - 1));
-		ActorItr->BestLocalAngle = LocalAttackAngles[Random];
-	}
+void ACooperativeAIGameMode::NotifyBotHitPlayer(int32 SubSwarmIndex, float AttackAngle)
+{
+	SwarmOptimizer.RecordHit(SubSwarmIndex, AttackAngle);
+}
 
-	// Random numbers to continue the solution space search both locally (one actor) and globally (whole swarm)
-	float RandomLocal, RandomGlobal;
 
-	// Weights on how much do the actual actor's angle, actor's best known angle and swarm's best known angle affect the next selected angle
-	float ConstantWeight = 0.1f, LocalWeight = 0.45f, GlobalWeight = 0.45f;
+void ACooperativeAIGameMode::NotifyBotKilled(int32 SubSwarmIndex, float AttackAngle)
+{
+	SwarmOptimizer.RecordMiss(SubSwarmIndex, AttackAngle);
+}
 
-	// The new angle an actor will take
-	float NewAngle;
 
-	for (TActorIterator<ASTrackerBot> ActorItr(GetWorld()); ActorItr; ++ActorItr)
+void ACooperativeAIGameMode::PrepareForNextWave()
+{
+	if (!bBenchmarkMode)
 	{
-		
-		RandomLocal = static_cast <float> (rand()) / (static_cast <float> (RAND_MAX / 1.0f));
-		RandomGlobal = static_cast <float> (rand()) / (static_cast <float> (RAND_MAX / 1.0f));
+		GetWorldTimerManager().SetTimer(TimerHandle_NextWaveStart, this, &ACooperativeAIGameMode::StartWave, TimeBetweenWaves, false);
+	}
 
-		NewAngle = (ConstantWeight * ActorItr->AttackAngle) + (LocalWeight * RandomLocal * ActorItr->BestLocalAngle) + (GlobalWeight * RandomGlobal * BestGlobalAngle);
+	SetWaveState(EWaveState::WaitingForNextWave);
 
-		NewAngle = fmod(NewAngle,360.0f);
+	bPrewarmingBotPool = true;
 
-		for (int AngleIndex = 0; AngleIndex < PossibleAttackAngles.Num(); AngleIndex++)
-		{
-			if (NewAngle < PossibleAttackAngles[AngleIndex]) {
-				NewAngle = PossibleAttackAngles[AngleIndex];
-				break;
-			}
-		}
+	// A benchmark removes the players' pawns on purpose
+	if (!bBenchmarkMode)
+	{
+		RestartDeadPlayers();
+	}
+}
 
-		ActorItr->AttackAngle = NewAngle;
 
-		if (HitAngles[NewAngle] > HitAngles[ActorItr->BestLocalAngle]) {
-			Random = (rand() % static_cast<int>((BOTS - 1) - 1));
-			LocalAttackAngles[Random] = NewAngle;
-			
-			if (HitAngles[ActorItr->BestLocalAngle] > HitAngles[BestGlobalAngle]) {
-				BestGlobalAngle = ActorItr->BestLocalAngle;
-			}
-		}
+void ACooperativeAIGameMode::NotifyPlayerAlive(APawn* PlayerPawn)
+{
+	if (PlayerPawn == nullptr || AlivePlayers.Contains(PlayerPawn))
+	{
+		return;
+	}
+
+	USHealthComponent* HealthComp = USHealthComponent::FindHealthComponent(PlayerPawn);
+	if (HealthComp)
+	{
+		AlivePlayers.Add(PlayerPawn);
+		AlivePlayerHealthComps.Add(HealthComp);
 	}
 }
 
 
-void ACooperativeAIGameMode::PrepareForNextWave()
+void ACooperativeAIGameMode::NotifyPlayerDied(APawn* PlayerPawn)
 {
-	GetWorldTimerManager().SetTimer(TimerHandle_NextWaveStart, this, &ACooperativeAIGameMode::StartWave, TimeBetweenWaves, false);
+	const int32 PlayerIndex = AlivePlayers.Find(PlayerPawn);
+	if (PlayerIndex == INDEX_NONE)
+	{
+		return;
+	}
 
-	SetWaveState(EWaveState::WaitingForNextWave);
+	AlivePlayers.RemoveAtSwap(PlayerIndex, 1, false);
+	AlivePlayerHealthComps.RemoveAtSwap(PlayerIndex, 1, false);
 
-	RestartDeadPlayers();
+	// No player alive, a world being torn down is not a lost game.
+	// Let the last pawn finish detaching from its controller first so RestartDeadPlayers sees it as dead
+	if (AlivePlayers.Num() == 0 && !GetWorld()->bIsTearingDown && !GetWorldTimerManager().TimerExists(TimerHandle_GameOver))
+	{
+		TimerHandle_GameOver = GetWorldTimerManager().SetTimerForNextTick(this, &ACooperativeAIGameMode::GameOver);
+	}
 }
 
 
-void ACooperativeAIGameMode::CheckAnyPlayerAlive()
+APawn* ACooperativeAIGameMode::FindNearestTarget(const FVector& Location, uint8 TeamNum) const
 {
-	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	APawn* BestTarget = nullptr;
+	float NearestTargetDistance = FLT_MAX;
+
+	for (int32 PlayerIndex = 0; PlayerIndex < AlivePlayers.Num(); PlayerIndex++)
 	{
-		APlayerController* PC = It->Get();
-		if (PC && PC->GetPawn())
+		const USHealthComponent* HealthComp = AlivePlayerHealthComps[PlayerIndex];
+		if (HealthComp->TeamNum == TeamNum || HealthComp->GetHealth() <= 0.0f)
 		{
-			APawn* MyPawn = PC->GetPawn();
-			USHealthComponent* HealthComp = Cast<USHealthComponent>(MyPawn->GetComponentByClass(USHealthComponent::StaticClass()));
-			if (ensure(HealthComp) && HealthComp->GetHealth() > 0.0f)
-			{
-				// A player is still alive.
-				return;
-			}
+			continue;
+		}
+
+		const float Distance = FVector::DistSquared(AlivePlayers[PlayerIndex]->GetActorLocation(), Location);
+		if (Distance < NearestTargetDistance)
+		{
+			BestTarget = AlivePlayers[PlayerIndex];
+			NearestTargetDistance = Distance;
 		}
 	}
 
-	// No player alive
-	GameOver();
+	return BestTarget;
 }
 
 
 void ACooperativeAIGameMode::GameOver()
 {
+	TimerHandle_GameOver.Invalidate();
+
+	// A player was possessed again before the deferred call came
+	if (AlivePlayers.Num() > 0)
+	{
+		return;
+	}
+
 	EndWave();
+	FinishWaveReport();
 
 
 	SetWaveState(EWaveState::GameOver);
@@ -306,41 +398,245 @@ void ACooperativeAIGameMode::Tick(float DeltaSeconds)
 {
 	Super::Tick(DeltaSeconds);
 
-	CheckAnyPlayerAlive();
-
-	TArray<AActor*> FoundActors;
-	UGameplayStatics::GetAllActorsOfClass(GetWorld(), ASTrackerBot::StaticClass(), FoundActors);
+	WaveReport.AddFrame(DeltaSeconds, BotRegistry.GetNumAlive());
+	SET_DWORD_STAT(STAT_BotsAlive, BotRegistry.GetNumAlive());
 
-	if (FoundActors.Num() > BOTS * 3) {
+	if (BotRegistry.Num() > MaxBotPopulation) {
 		NrOfBotsToSpawn = 0;
 	}
+
+	if (UseFlowFields)
+	{
+		FlowFields.Tick(GetWorld(), AlivePlayers, 1);
+	}
+	else
+	{
+		FlowFields.Reset();
+	}
+
+	Significance.Tick(DeltaSeconds, BotRegistry, AlivePlayers);
+
+	Proximity.Tick(BotRegistry, AlivePlayers);
+
+	Movement.Tick(DeltaSeconds, BotRegistry);
+
+	PathQueue.Tick(GetWorld()->GetTimeSeconds(), PathBudgetMicroseconds / 1000000.0);
+
+	TickSpawnScheduler();
+
+	Explosions.Tick(GetWorld());
 }
 
 void ACooperativeAIGameMode::SetStochasticMode()
 {
-	bStochasticMode = true;
+	TArray<ESwarmStrategy> Strategies;
+	Strategies.Add(ESwarmStrategy::StochasticDiffusion);
+	SetSwarmStrategies(Strategies);
 }
 
 void ACooperativeAIGameMode::SetAntColonyMode()
 {
-	bAntColonyMode = true;
+	TArray<ESwarmStrategy> Strategies;
+	Strategies.Add(ESwarmStrategy::AntColony);
+	SetSwarmStrategies(Strategies);
 }
 
 void ACooperativeAIGameMode::SetParticleSwarmMode()
 {
-	bParticleSwarmMode = true;
+	TArray<ESwarmStrategy> Strategies;
+	Strategies.Add(ESwarmStrategy::ParticleSwarm);
+	SetSwarmStrategies(Strategies);
+}
+
+void ACooperativeAIGameMode::SetSubSwarmModes(const FString& Modes)
+{
+	TArray<FString> ModeNames;
+	Modes.ParseIntoArray(ModeNames, TEXT(","));
+
+	TArray<ESwarmStrategy> Strategies;
+	for (const FString& ModeName : ModeNames)
+	{
+		ESwarmStrategy Strategy = ParseSwarmStrategy(ModeName.TrimStartAndEnd());
+		if (Strategy != ESwarmStrategy::None)
+		{
+			Strategies.Add(Strategy);
+		}
+	}
+
+	SetSwarmStrategies(Strategies);
+}
+
+void ACooperativeAIGameMode::StartSpawningBots()
+{
+	bSpawningBots = true;
+}
+
+
+void ACooperativeAIGameMode::SetBotPopulation(int32 InBotsPerWave, int32 InMaxBotPopulation)
+{
+	BotsPerWave = FMath::Max(1, InBotsPerWave);
+	MaxBotPopulation = FMath::Max(1, InMaxBotPopulation);
+}
+
+
+void ACooperativeAIGameMode::StartBenchmarkWave()
+{
+	bBenchmarkMode = true;
+	GetWorldTimerManager().ClearTimer(TimerHandle_NextWaveStart);
+
+	StartWave();
+
+	// No start delay
+	GetWorldTimerManager().ClearTimer(TimerHandle_BotSpawner);
+	StartSpawningBots();
+}
+
+
+void ACooperativeAIGameMode::DestroyAllBots()
+{
+	bSpawningBots = false;
+	NrOfBotsToSpawn = 0;
+
+	// Destroying unregisters the bot, so work on a copy
+	TArray<ASTrackerBot*> Bots = BotRegistry.GetBots();
+	for (ASTrackerBot* Bot : Bots)
+	{
+		Bot->Destroy();
+	}
+
+	for (ASTrackerBot* Bot : BotPool)
+	{
+		if (Bot)
+		{
+			Bot->Destroy();
+		}
+	}
+	BotPool.Reset();
+	bPrewarmingBotPool = false;
+
+	PathQueue.Reset();
+	Explosions.Reset();
+}
+
+void ACooperativeAIGameMode::PrewarmBot()
+{
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	ASTrackerBot* Bot = GetWorld()->SpawnActor<ASTrackerBot>(PooledBotClass, GetActorLocation(), FRotator::ZeroRotator, SpawnParams);
+	if (Bot)
+	{
+		Bot->DeactivateForPool();
+		BotPool.Add(Bot);
+	}
+	else
+	{
+		// Nothing will spawn until the next wave either
+		bPrewarmingBotPool = false;
+	}
+}
+
+ASTrackerBot* ACooperativeAIGameMode::AcquireBot(TSubclassOf<ASTrackerBot> BotClass, const FTransform& SpawnTransform)
+{
+	if (BotClass == nullptr)
+	{
+		BotClass = PooledBotClass;
+	}
+
+	bAcquiringBots = true;
+
+	for (int32 Index = BotPool.Num() - 1; Index >= 0; Index--)
+	{
+		ASTrackerBot* Bot = BotPool[Index];
+		if (Bot && Bot->GetClass() == BotClass)
+		{
+			BotPool.RemoveAtSwap(Index, 1, false);
+			Bot->ResetForReuse(SpawnTransform);
+			return Bot;
+		}
+	}
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+	return BotClass ? GetWorld()->SpawnActor<ASTrackerBot>(BotClass, SpawnTransform, SpawnParams) : nullptr;
 }
 
-void ACooperativeAIGameMode::SpawnBotTimerElapsed()
+void ACooperativeAIGameMode::SpawnPooledBot()
 {
-	SpawnNewBot();
+	FEnvQueryRequest SpawnRequest(BotSpawnQuery, this);
+	SpawnRequest.Execute(EEnvQueryRunMode::RandomBest25Pct, this, &ACooperativeAIGameMode::OnBotSpawnQueryFinished);
+}
 
-	NrOfBotsToSpawn--;
+void ACooperativeAIGameMode::OnBotSpawnQueryFinished(TSharedPtr<FEnvQueryResult> Result)
+{
+	if (Result.IsValid() && Result->IsSuccsessful() && Result->Items.Num() > 0)
+	{
+		AcquireBot(PooledBotClass, FTransform(Result->GetItemAsLocation(0)));
+	}
+}
 
-	if (NrOfBotsToSpawn <= 0)
+void ACooperativeAIGameMode::ReleaseBot(ASTrackerBot* Bot)
+{
+	if (Bot == nullptr || Bot->IsPooled())
 	{
-		EndWave();
+		return;
 	}
 
+	// Kept only when bots are handed out again, and no more than a wave needs
+	if (!bAcquiringBots || BotPool.Num() >= FMath::Max(BotPoolSize, BotsPerWave))
+	{
+		Bot->Destroy();
+		return;
+	}
 
-}
\ No newline at end of file
+	Bot->DeactivateForPool();
+	BotPool.Add(Bot);
+}
+
+void ACooperativeAIGameMode::TickSpawnScheduler()
+{
+	COOP_SCOPE_CYCLE_COUNTER(STAT_SpawnScheduler, Spawning);
+
+	const double StartTime = FPlatformTime::Seconds();
+	const double Budget = SpawnBudgetMicroseconds / 1000000.0;
+	bool bBudgetLeft = true;
+
+	if (bSpawningBots)
+	{
+		int32 NumSpawned = 0;
+		while (NrOfBotsToSpawn > 0 && NumSpawned < MaxBotSpawnsPerFrame && (bBudgetLeft || NumSpawned == 0))
+		{
+			if (PooledBotClass && BotSpawnQuery)
+			{
+				SpawnPooledBot();
+			}
+			else
+			{
+				SpawnNewBot();
+			}
+
+			NrOfBotsToSpawn--;
+			NumSpawned++;
+			bBudgetLeft = (FPlatformTime::Seconds() - StartTime) < Budget;
+		}
+
+		if (NrOfBotsToSpawn <= 0)
+		{
+			EndWave();
+		}
+	}
+	else if (bPrewarmingBotPool && PooledBotClass && bAcquiringBots)
+	{
+		int32 NumSpawned = 0;
+		while (BotPool.Num() < BotPoolSize && NumSpawned < MaxBotSpawnsPerFrame && bBudgetLeft)
+		{
+			PrewarmBot();
+
+			NumSpawned++;
+			bBudgetLeft = (FPlatformTime::Seconds() - StartTime) < Budget;
+		}
+	}
+
+	SET_DWORD_STAT(STAT_BotSpawnQueue, bSpawningBots ? FMath::Max(NrOfBotsToSpawn, 0) : 0);
+}
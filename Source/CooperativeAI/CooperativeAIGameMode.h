@@ -4,10 +4,24 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/GameModeBase.h"
+#include "SwarmOptimizer.h"
+#include "TrackerBotRegistry.h"
+#include "TrackerBotPathQueue.h"
+#include "TrackerBotFlowFields.h"
+#include "TrackerBotSignificance.h"
+#include "TrackerBotMovement.h"
+#include "TrackerBotProximity.h"
+#include "TrackerBotExplosions.h"
+#include "DamageTelemetry.h"
+#include "TeamRegistry.h"
+#include "WaveReport.h"
 #include "CooperativeAIGameMode.generated.h"
 #define BOTS 20
-#define EVAPORATION_RATE 0.25f
 enum class EWaveState : uint8;
+class ASTrackerBot;
+class USHealthComponent;
+class UEnvQuery;
+struct FEnvQueryResult;
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FOnActorKilled, AActor*, VictimActor, AActor*, KillerActor, AController*, KillerController);
 
@@ -18,21 +32,139 @@ class ACooperativeAIGameMode : public AGameModeBase
 
 public:
 	ACooperativeAIGameMode();
+	virtual void InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage) override;
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 protected:
 
 	FTimerHandle TimerHandle_BotSpawner;
 
 	FTimerHandle TimerHandle_NextWaveStart;
 
-	// Bots to spawn in current wave
+	// Deferred GameOver after the last player died, set at most once
+	FTimerHandle TimerHandle_GameOver;
+
+	// Bots to spawn in current wave, the depth of the spawn queue
 	int32 NrOfBotsToSpawn;
 
+	// Whether the spawn queue is being drained, set once the wave's start delay is over
+	bool bSpawningBots;
+
+	// Most bots spawned in a single frame
+	UPROPERTY(EditDefaultsOnly, Category = "GameMode", meta = (ClampMin = 1))
+		int32 MaxBotSpawnsPerFrame;
+
+	// Time per frame the spawn queue may take, in microseconds. Always lets at least one through
+	UPROPERTY(EditDefaultsOnly, Category = "GameMode", meta = (ClampMin = 0))
+		float SpawnBudgetMicroseconds;
+
+	// Time per frame spent starting queued bot path queries, in microseconds. Always lets at least one through
+	UPROPERTY(EditDefaultsOnly, Category = "GameMode", meta = (ClampMin = 0))
+		float PathBudgetMicroseconds;
+
+	// Path requests of every bot, answered asynchronously
+	FTrackerBotPathQueue PathQueue;
+
+	// One field per living player the bots step along, path queries are only needed outside of them
+	FTrackerBotFlowFields FlowFields;
+
+	// LOD tiers of the bots by distance to the players
+	FTrackerBotSignificance Significance;
+
+	// Steers all bots in one batch, the bots do not tick themselves
+	FTrackerBotMovement Movement;
+
+	// Starts the self destruct of the bots that reached a player
+	FTrackerBotProximity Proximity;
+
+	// Explosions of the frame, resolved together at the end of the game mode's tick
+	FTrackerBotExplosions Explosions;
+
+	// Health changes of the match, written to disk on a background thread
+	FDamageTelemetry DamageTelemetry;
+
+	// Frame times and COOP scope times of each wave, from its start to the next wave or the end of the game
+	FWaveReport WaveReport;
+
+	// Waves started this match
+	int32 WaveNumber;
+
+	// Driven by a benchmark, waves do not follow each other on their own and dead players are not restarted
+	bool bBenchmarkMode;
+
+	// Path queue's query and cache hit counts when the current wave started
+	int32 WavePathQueriesAtStart;
+	int32 WavePathCacheHitsAtStart;
+
+	// Bots spawned by every wave, BOTS unless overridden with ?Bots= or SetBotPopulation
+	UPROPERTY(EditDefaultsOnly, Category = "GameMode", meta = (ClampMin = 1))
+		int32 BotsPerWave;
+
+	// Most bots in the world at once, spawning stops for the wave beyond it. Overridden with ?MaxBots=
+	UPROPERTY(EditDefaultsOnly, Category = "GameMode", meta = (ClampMin = 1))
+		int32 MaxBotPopulation;
+
+	// Every bot of the next waves moves kinematically instead of as a simulated rigid body, for large crowds
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "GameMode")
+		bool bKinematicBots;
+
+	// Bots in this LOD tier (0 near, 1 mid, 2 far) and further move kinematically, 3 keeps every tier simulated
+	UPROPERTY(EditDefaultsOnly, Category = "GameMode", meta = (ClampMin = 0, ClampMax = 3))
+		int32 KinematicLODTier;
+
+	// Bot class the spawn scheduler acquires from the pool and pre-warms it with. When empty, SpawnNewBot is left to BP and nothing is pooled
+	UPROPERTY(EditDefaultsOnly, Category = "GameMode")
+		TSubclassOf<ASTrackerBot> PooledBotClass;
+
+	// Finds where a pooled bot spawns, run for every bot
+	UPROPERTY(EditDefaultsOnly, Category = "GameMode")
+		UEnvQuery* BotSpawnQuery;
+
+	// Set once a bot was handed out through AcquireBot, until then released bots are destroyed instead of kept
+	bool bAcquiringBots;
+
+	// Idle bots the pool is filled up to between waves
+	UPROPERTY(EditDefaultsOnly, Category = "GameMode", meta = (ClampMin = 0))
+		int32 BotPoolSize;
+
+	// Exploded or pre-warmed bots waiting to be handed out again
+	UPROPERTY()
+		TArray<ASTrackerBot*> BotPool;
+
+	// Set while waiting for the next wave, the spawn scheduler fills the pool within its budget
+	bool bPrewarmingBotPool;
+
 	UPROPERTY(EditDefaultsOnly, Category = "GameMode")
 		float TimeBetweenWaves;
 
-	// Array of angles from which the bots can attack
-	TArray<float> PossibleAttackAngles;
+	// Number of angle buckets around the player the swarm can attack from, independent of the bots per wave
+	UPROPERTY(EditDefaultsOnly, Category = "GameMode", meta = (ClampMin = 3))
+		int32 NumAttackAngles;
+
+	// Seed of the swarm random streams, 0 picks a new one every match. Overridden by the ?SwarmSeed= server option
+	UPROPERTY(EditDefaultsOnly, Category = "GameMode")
+		int32 SwarmSeed;
+
+	// Learning core shared by all swarm strategies
+	FSwarmOptimizer SwarmOptimizer;
+
+	// One sub-swarm per entry, new bots are dealt round robin between them. Set by the SetXMode functions or the ?SwarmModes= server option
+	TArray<ESwarmStrategy> SwarmStrategies;
+
+	// Sub-swarm the next unassigned bot joins
+	int32 NextSubSwarm;
+
+	// Every tracker bot in the world, kept up to date by the bots themselves
+	FTrackerBotRegistry BotRegistry;
+
+	// Player controlled pawns that are still alive, kept up to date by the pawns on possession and death
+	TArray<APawn*> AlivePlayers;
+
+	// Health component of each alive player, looked up once when the player is added
+	TArray<USHealthComponent*> AlivePlayerHealthComps;
+
+	// Health component and team of every actor that has one, kept up to date by the components themselves
+	FTeamRegistry TeamRegistry;
 
 protected:
 
@@ -40,13 +172,25 @@ protected:
 	UFUNCTION(BlueprintImplementableEvent, Category = "GameMode")
 		void SpawnNewBot();
 
-	void StochasticDiffusionSearch();
+	// Acquires a bot of PooledBotClass at a location found by BotSpawnQuery
+	void SpawnPooledBot();
+
+	void OnBotSpawnQueryFinished(TSharedPtr<FEnvQueryResult> Result);
+
+	// Runs each sub-swarm's strategy over its bots alive in the world and writes the new angles back
+	void UpdateSwarm();
 
-	void AntColonyOptimization();
+	// Restarts the learning with one sub-swarm per strategy
+	void SetSwarmStrategies(const TArray<ESwarmStrategy>& Strategies);
 
-	void ParticleSwarmOptimization();
+	// Wave start delay is over, let the spawn queue drain
+	void StartSpawningBots();
 
-	void SpawnBotTimerElapsed();
+	// Spawns queued bots within this frame's budget
+	void TickSpawnScheduler();
+
+	// Spawns a parked bot straight into the pool
+	void PrewarmBot();
 
 	// Start Spawning Bots
 	void StartWave();
@@ -54,11 +198,12 @@ protected:
 	// Stop Spawning Bots
 	void EndWave();
 
+	// Writes the row of the wave being recorded, if any
+	void FinishWaveReport();
+
 	// Set timer for next startwave
 	void PrepareForNextWave();
 
-	void CheckAnyPlayerAlive();
-
 	void GameOver();
 
 	void SetWaveState(EWaveState NewState);
@@ -74,12 +219,6 @@ public:
 	UPROPERTY(BlueprintAssignable, Category = "GameMode")
 		FOnActorKilled OnActorKilled;
 
-	bool bStochasticMode;
-
-	bool bAntColonyMode;
-
-	bool bParticleSwarmMode;
-
 	UFUNCTION(BlueprintCallable, Category = "GameMode")
 		void SetStochasticMode();
 
@@ -89,21 +228,65 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "GameMode")
 		void SetParticleSwarmMode();
 
+	// Splits the bots between several strategies running side by side, e.g. "SDS,ACO,PSO"
+	UFUNCTION(BlueprintCallable, Category = "GameMode")
+		void SetSubSwarmModes(const FString& Modes);
+
+	// A bot of the sub-swarm reached and damaged a player approaching through AttackAngle
+	void NotifyBotHitPlayer(int32 SubSwarmIndex, float AttackAngle);
+
+	// A bot of the sub-swarm was killed before damaging anyone
+	void NotifyBotKilled(int32 SubSwarmIndex, float AttackAngle);
+
+	const FSwarmOptimizer& GetSwarmOptimizer() const { return SwarmOptimizer; }
+
+	FTrackerBotRegistry& GetBotRegistry() { return BotRegistry; }
+
+	const FTrackerBotRegistry& GetBotRegistry() const { return BotRegistry; }
+
+	// Hands out a pooled bot of BotClass reset at SpawnTransform, or spawns a new one when none is idle. Use instead of SpawnActor in a BP SpawnNewBot
+	UFUNCTION(BlueprintCallable, Category = "GameMode")
+		ASTrackerBot* AcquireBot(TSubclassOf<ASTrackerBot> BotClass, const FTransform& SpawnTransform);
+
+	// Takes back an exploded bot, destroys it when the pool is already full or nothing acquires bots
+	void ReleaseBot(ASTrackerBot* Bot);
+
+	FTrackerBotPathQueue& GetPathQueue() { return PathQueue; }
+
+	FTrackerBotExplosions& GetExplosions() { return Explosions; }
+
+	FDamageTelemetry& GetDamageTelemetry() { return DamageTelemetry; }
+
+	FTeamRegistry& GetTeamRegistry() { return TeamRegistry; }
+
+	// Overrides the bots spawned by the next waves and the population cap, for benchmarks and large crowd tests
+	void SetBotPopulation(int32 InBotsPerWave, int32 InMaxBotPopulation);
+
+	// Starts a wave of BotsPerWave bots right away, spawned as fast as the spawn budget allows, and no next wave after it
+	void StartBenchmarkWave();
+
+	// Destroys every bot, in the world and in the pool, between benchmark steps
+	void DestroyAllBots();
+
+	// Overrides how many bots the spawn scheduler may spawn per frame and its time budget
+	void SetSpawnRate(int32 InMaxBotSpawnsPerFrame, float InSpawnBudgetMicroseconds)
+	{
+		MaxBotSpawnsPerFrame = FMath::Max(1, InMaxBotSpawnsPerFrame);
+		SpawnBudgetMicroseconds = InSpawnBudgetMicroseconds;
+	}
 
-	// <AttackAngle, Has damage been done through this angle on the previous wave>
-	TMap<float, bool> AnglesDamaged;
+	const FTrackerBotFlowFields& GetFlowFields() const { return FlowFields; }
 
-	// <AttackAngle, Pheromone quantity>
-	TMap<float, float> PheromoneQuantities;
+	// A player took control of a living pawn
+	void NotifyPlayerAlive(APawn* PlayerPawn);
 
-	// <AttackAngle, Times succesfully hit>
-	TMap<float, float> HitAngles;
+	// A player pawn died or lost its controller, the game is over as soon as none is left
+	void NotifyPlayerDied(APawn* PlayerPawn);
 
-	// Stores the current best angle for the swarm in PSO mode
-	float BestGlobalAngle;
+	int32 GetNumAlivePlayers() const { return AlivePlayers.Num(); }
 
-	// Array of best local angles to transmit information between waves in PSO
-	TArray<float> LocalAttackAngles;
+	// Nearest alive player not on TeamNum, only walks the alive players so the cost does not depend on the number of bots
+	APawn* FindNearestTarget(const FVector& Location, uint8 TeamNum) const;
 };
 
 
@@ -0,0 +1,255 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "DamageTelemetry.h"
+#include "CooperativeAI.h"
+#include "HAL/RunnableThread.h"
+#include "HAL/PlatformFilemanager.h"
+#include "HAL/PlatformProcess.h"
+#include "Misc/Paths.h"
+#include "Misc/DateTime.h"
+#include "GameFramework/Actor.h"
+#include "GameFramework/Controller.h"
+#include "GameFramework/DamageType.h"
+
+static int32 DamageTelemetryLevel = 0;
+FAutoConsoleVariableRef CVARDamageTelemetryLevel(
+	TEXT("COOP.DamageTelemetry"),
+	DamageTelemetryLevel,
+	TEXT("Damage telemetry: 0 off, 1 binary file in Saved/Telemetry, 2 file and log"),
+	ECVF_Default);
+
+// 'DMGT', followed by the version and the size of one event
+static const uint32 TelemetryMagic = 0x544D4744;
+static const uint32 TelemetryVersion = 2;
+
+// Chunks follow the header, each a type and an entry count.
+// 'NAME' entries are an int32 name index, a uint32 length and that many UTF-8 bytes, 'EVNT' entries are FDamageTelemetryEvents.
+// A name with a number N > 0 reads as <text>_<N - 1>, like FName::ToString
+static const uint32 NameChunk = 0x454D414E;
+static const uint32 EventChunk = 0x544E5645;
+
+// Seconds the drain thread sleeps between two drains
+static const float DrainInterval = 0.1f;
+
+
+FDamageTelemetry::FDamageTelemetry()
+	: Head(0)
+	, Tail(0)
+	, bStopping(false)
+	, NumDropped(0)
+	, bStarted(false)
+	, Thread(nullptr)
+	, File(nullptr)
+	, NumNamesInBuffer(0)
+{
+}
+
+
+FDamageTelemetry::~FDamageTelemetry()
+{
+	Shutdown();
+}
+
+
+bool FDamageTelemetry::IsEnabled()
+{
+	return DamageTelemetryLevel > 0;
+}
+
+
+void FDamageTelemetry::Record(AActor* Victim, AController* InstigatedBy, const UDamageType* DamageType, float Amount, float HealthAfter)
+{
+	if (!bStarted)
+	{
+		Start();
+	}
+
+	const uint32 CurrentHead = Head.Load(EMemoryOrder::Relaxed);
+	if (CurrentHead - Tail.Load() >= Capacity)
+	{
+		NumDropped++;
+		return;
+	}
+
+	FDamageTelemetryEvent& Event = Events[CurrentHead & (Capacity - 1)];
+	Event.Time = FPlatformTime::Seconds();
+	const FName VictimName = Victim ? Victim->GetFName() : NAME_None;
+	const FName InstigatorName = InstigatedBy ? InstigatedBy->GetFName() : NAME_None;
+	Event.VictimName = VictimName.GetComparisonIndex();
+	Event.VictimNumber = VictimName.GetNumber();
+	Event.InstigatorName = InstigatorName.GetComparisonIndex();
+	Event.InstigatorNumber = InstigatorName.GetNumber();
+	Event.DamageTypeName = DamageType ? DamageType->GetClass()->GetFName().GetComparisonIndex() : NAME_None.GetComparisonIndex();
+	Event.Amount = Amount;
+	Event.HealthAfter = HealthAfter;
+	Event.Padding = 0;
+
+	// Publishes the filled slot to the drain thread
+	Head.Store(CurrentHead + 1);
+
+	if (!Thread)
+	{
+		Drain();
+	}
+}
+
+
+void FDamageTelemetry::Shutdown()
+{
+	if (Thread)
+	{
+		Thread->Kill(true);
+		delete Thread;
+		Thread = nullptr;
+	}
+
+	if (File)
+	{
+		delete File;
+		File = nullptr;
+	}
+
+	if (NumDropped > 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Damage telemetry dropped %d events"), NumDropped);
+	}
+
+	Head = 0;
+	Tail = 0;
+	bStopping = false;
+	NumDropped = 0;
+	bStarted = false;
+	WrittenNames.Reset();
+}
+
+
+void FDamageTelemetry::Start()
+{
+	const FString FileName = FPaths::ProjectSavedDir() / TEXT("Telemetry") / FString::Printf(TEXT("Damage-%s.bin"), *FDateTime::Now().ToString());
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	PlatformFile.CreateDirectoryTree(*FPaths::GetPath(FileName));
+	File = PlatformFile.OpenWrite(*FileName);
+	if (File)
+	{
+		const uint32 Header[3] = { TelemetryMagic, TelemetryVersion, (uint32)sizeof(FDamageTelemetryEvent) };
+		File->Write((const uint8*)Header, sizeof(Header));
+	}
+	else
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Damage telemetry could not open %s, events are only logged"), *FileName);
+	}
+
+	Events.SetNumUninitialized(Capacity);
+	WriteBuffer.Reserve(Capacity);
+	bStopping = false;
+	bStarted = true;
+
+	if (FPlatformProcess::SupportsMultithreading())
+	{
+		Thread = FRunnableThread::Create(this, TEXT("DamageTelemetry"), 0, TPri_BelowNormal);
+	}
+
+	if (!Thread)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Damage telemetry has no drain thread, draining on the game thread"));
+	}
+}
+
+
+uint32 FDamageTelemetry::Run()
+{
+	while (!bStopping)
+	{
+		Drain();
+		FPlatformProcess::Sleep(DrainInterval);
+	}
+
+	// Whatever the game thread pushed before stopping us
+	Drain();
+	if (File)
+	{
+		File->Flush();
+	}
+	return 0;
+}
+
+
+void FDamageTelemetry::Stop()
+{
+	bStopping = true;
+}
+
+
+void FDamageTelemetry::Drain()
+{
+	const uint32 CurrentTail = Tail.Load(EMemoryOrder::Relaxed);
+	const uint32 CurrentHead = Head.Load();
+	if (CurrentHead == CurrentTail)
+	{
+		return;
+	}
+
+	WriteBuffer.Reset();
+	for (uint32 Index = CurrentTail; Index != CurrentHead; Index++)
+	{
+		WriteBuffer.Add(Events[Index & (Capacity - 1)]);
+	}
+
+	// Frees the slots for the game thread
+	Tail.Store(CurrentHead);
+
+	// The text of names the file does not have yet goes ahead of the events using them
+	NameBuffer.Reset();
+	NumNamesInBuffer = 0;
+	for (const FDamageTelemetryEvent& Event : WriteBuffer)
+	{
+		AddName(Event.VictimName);
+		AddName(Event.InstigatorName);
+		AddName(Event.DamageTypeName);
+	}
+
+	if (File)
+	{
+		if (NumNamesInBuffer > 0)
+		{
+			const uint32 NameChunkHeader[2] = { NameChunk, (uint32)NumNamesInBuffer };
+			File->Write((const uint8*)NameChunkHeader, sizeof(NameChunkHeader));
+			File->Write(NameBuffer.GetData(), NameBuffer.Num());
+		}
+
+		const uint32 EventChunkHeader[2] = { EventChunk, (uint32)WriteBuffer.Num() };
+		File->Write((const uint8*)EventChunkHeader, sizeof(EventChunkHeader));
+		File->Write((const uint8*)WriteBuffer.GetData(), WriteBuffer.Num() * sizeof(FDamageTelemetryEvent));
+	}
+
+	if (DamageTelemetryLevel > 1)
+	{
+		for (const FDamageTelemetryEvent& Event : WriteBuffer)
+		{
+			const FName VictimName(Event.VictimName, Event.VictimName, Event.VictimNumber);
+			const FName InstigatorName(Event.InstigatorName, Event.InstigatorName, Event.InstigatorNumber);
+			UE_LOG(LogTemp, Log, TEXT("Health Changed: %s by %s, %.2f -> %.2f"), *VictimName.ToString(), *InstigatorName.ToString(), Event.Amount, Event.HealthAfter);
+		}
+	}
+}
+
+
+void FDamageTelemetry::AddName(int32 Index)
+{
+	bool bAlreadyWritten = false;
+	WrittenNames.Add(Index, &bAlreadyWritten);
+	if (bAlreadyWritten)
+	{
+		return;
+	}
+
+	const FString Text = FName(Index, Index, NAME_NO_NUMBER_INTERNAL).GetPlainNameString();
+	const FTCHARToUTF8 TextUTF8(*Text);
+	const int32 Length = TextUTF8.Length();
+
+	NameBuffer.Append((const uint8*)&Index, sizeof(Index));
+	NameBuffer.Append((const uint8*)&Length, sizeof(Length));
+	NameBuffer.Append((const uint8*)TextUTF8.Get(), Length);
+	NumNamesInBuffer++;
+}
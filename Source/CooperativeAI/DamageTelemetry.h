@@ -0,0 +1,110 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "Templates/Atomic.h"
+#include "HAL/ThreadSafeBool.h"
+
+class AActor;
+class AController;
+class UDamageType;
+class FRunnableThread;
+class IFileHandle;
+
+// One health change as written to the telemetry file, fixed size and plain data
+struct FDamageTelemetryEvent
+{
+	// FPlatformTime::Seconds() when the change happened
+	double Time;
+
+	// FName of the victim and instigating controller as comparison index and number, resolved by the file's name chunks. NAME_None when there is none
+	int32 VictimName;
+	int32 VictimNumber;
+	int32 InstigatorName;
+	int32 InstigatorNumber;
+
+	// FName of the damage type class, NAME_None for heals and untyped damage
+	int32 DamageTypeName;
+
+	// Negative when healed
+	float Amount;
+
+	float HealthAfter;
+
+	uint32 Padding;
+};
+
+/**
+ * Damage telemetry without any work on the game thread beyond copying a few numbers.
+ * The game thread pushes events into a fixed single producer, single consumer ring and a background thread drains it
+ * to a binary file in Saved/Telemetry. The file is a header followed by chunks: events only carry name indices, and the drain
+ * thread writes a name chunk with the text of every index the first time it shows up, ahead of the events using it.
+ * Without multithreading the ring is drained on the game thread after every event. COOP.DamageTelemetry picks what is recorded: 0 nothing, 1 the file,
+ * 2 the file and one log line per event, formatted on the drain thread. Events are dropped and counted when the ring is full.
+ */
+class FDamageTelemetry : public FRunnable
+{
+public:
+
+	FDamageTelemetry();
+
+	virtual ~FDamageTelemetry();
+
+	// Whether the current verbosity records anything, checked before gathering the event's data
+	static bool IsEnabled();
+
+	// Game thread only. Opens the file and starts the drain thread on the first event
+	void Record(AActor* Victim, AController* InstigatedBy, const UDamageType* DamageType, float Amount, float HealthAfter);
+
+	// Drains what is left, closes the file and stops the thread
+	void Shutdown();
+
+	int32 GetNumDropped() const { return NumDropped; }
+
+	// FRunnable
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+
+protected:
+
+	void Start();
+
+	// Moves everything in the ring to the file, drain thread only, or the game thread when there is none
+	void Drain();
+
+	// Queues a name chunk entry for Index if the file does not have its text yet
+	void AddName(int32 Index);
+
+	// Power of two, so indices wrap with a mask
+	static const uint32 Capacity = 8192;
+
+	// Allocated once when the drain thread starts
+	TArray<FDamageTelemetryEvent> Events;
+
+	// Next slot the game thread writes, only written by the game thread
+	TAtomic<uint32> Head;
+
+	// Next slot the drain thread reads, only written by the drain thread
+	TAtomic<uint32> Tail;
+
+	FThreadSafeBool bStopping;
+
+	int32 NumDropped;
+
+	// Set by the first event, the file is opened and the thread created only once per match
+	bool bStarted;
+
+	FRunnableThread* Thread;
+
+	IFileHandle* File;
+
+	// Drain thread's copy of the events it is writing
+	TArray<FDamageTelemetryEvent> WriteBuffer;
+
+	// Drain thread's name chunk being built, and the name indices already written to the file
+	TArray<uint8> NameBuffer;
+	int32 NumNamesInBuffer;
+	TSet<int32> WrittenNames;
+};
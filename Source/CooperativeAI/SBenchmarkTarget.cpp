@@ -0,0 +1,48 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SBenchmarkTarget.h"
+#include "Components/CapsuleComponent.h"
+#include "Engine/World.h"
+#include "SHealthComponent.h"
+#include "CooperativeAIGameMode.h"
+
+
+// Sets default values
+ASBenchmarkTarget::ASBenchmarkTarget()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	CapsuleComp = CreateDefaultSubobject<UCapsuleComponent>(TEXT("CapsuleComp"));
+	CapsuleComp->InitCapsuleSize(42.0f, 96.0f);
+	CapsuleComp->SetCollisionProfileName(TEXT("Pawn"));
+	RootComponent = CapsuleComp;
+
+	HealthComp = CreateDefaultSubobject<USHealthComponent>(TEXT("HealthComp"));
+	HealthComp->TeamNum = 0;
+
+	bCanBeDamaged = false;
+}
+
+// Called when the game starts or when spawned
+void ASBenchmarkTarget::BeginPlay()
+{
+	Super::BeginPlay();
+
+	ACooperativeAIGameMode* MyGameMode = Cast<ACooperativeAIGameMode>(GetWorld()->GetAuthGameMode());
+	if (MyGameMode)
+	{
+		MyGameMode->NotifyPlayerAlive(this);
+	}
+}
+
+
+void ASBenchmarkTarget::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	ACooperativeAIGameMode* MyGameMode = Cast<ACooperativeAIGameMode>(GetWorld()->GetAuthGameMode());
+	if (MyGameMode)
+	{
+		MyGameMode->NotifyPlayerDied(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
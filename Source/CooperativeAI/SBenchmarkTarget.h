@@ -0,0 +1,37 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Pawn.h"
+#include "SBenchmarkTarget.generated.h"
+
+class UCapsuleComponent;
+class USHealthComponent;
+
+/**
+ * Stationary target the tracker bots hunt in the scaling benchmark.
+ * Counts as an alive player for the game mode but cannot be damaged and never sets the bots off, so the population stays
+ * the one the benchmark asked for.
+ */
+UCLASS()
+class ASBenchmarkTarget : public APawn
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this pawn's properties
+	ASBenchmarkTarget();
+
+protected:
+	// Called when the game starts or when spawned
+	virtual void BeginPlay() override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	UPROPERTY(VisibleDefaultsOnly, Category = "Components")
+		UCapsuleComponent* CapsuleComp;
+
+	UPROPERTY(VisibleDefaultsOnly, Category = "Components")
+		USHealthComponent* HealthComp;
+};
@@ -3,6 +3,7 @@
 #include "SHealthComponent.h"
 #include "CooperativeAIGameMode.h"
 #include "Net/UnrealNetwork.h"
+#include "Engine/World.h"
 
 
 // Sets default values for this component's properties
@@ -27,6 +28,32 @@ void USHealthComponent::BeginPlay()
 			MyOwner->OnTakeAnyDamage.AddDynamic(this, &USHealthComponent::HandleTakeAnyDamage);
 	}
 	Health = DefaultHealth;
+
+	FTeamRegistry* TeamRegistry = GetTeamRegistry();
+	if (TeamRegistry)
+	{
+		TeamRegistry->Register(this);
+	}
+}
+
+
+void USHealthComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	FTeamRegistry* TeamRegistry = GetTeamRegistry();
+	if (TeamRegistry)
+	{
+		TeamRegistry->Unregister(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+
+FTeamRegistry* USHealthComponent::GetTeamRegistry() const
+{
+	UWorld* World = GetWorld();
+	ACooperativeAIGameMode* MyGameMode = World ? Cast<ACooperativeAIGameMode>(World->GetAuthGameMode()) : nullptr;
+	return MyGameMode ? &MyGameMode->GetTeamRegistry() : nullptr;
 }
 
 
@@ -38,7 +65,7 @@ void USHealthComponent::HandleTakeAnyDamage(AActor* DamagedActor, float Damage,
 		return;
 	}
 
-	if (DamageCauser != DamagedActor && IsFriendly(DamagedActor, DamageCauser))
+	if (DamageCauser != DamagedActor && IsFriendly(this, FindHealthComponent(DamageCauser)))
 	{
 		return;
 	}
@@ -46,7 +73,7 @@ void USHealthComponent::HandleTakeAnyDamage(AActor* DamagedActor, float Damage,
 	// Update health clamped
 	Health = FMath::Clamp(Health - Damage, 0.0f, DefaultHealth);
 
-	UE_LOG(LogTemp, Log, TEXT("Health Changed: %s"), *FString::SanitizeFloat(Health));
+	RecordTelemetry(DamageType, InstigatedBy, Damage);
 
 	bIsDead = Health <= 0.0f;
 
@@ -64,12 +91,34 @@ void USHealthComponent::Heal(float HealAmount)
 
 	Health = FMath::Clamp(Health + HealAmount, 0.0f, DefaultHealth);
 
-	UE_LOG(LogTemp, Log, TEXT("Health Changed: %s (+%s)"), *FString::SanitizeFloat(Health), *FString::SanitizeFloat(HealAmount));
+	RecordTelemetry(nullptr, nullptr, -HealAmount);
 
 	OnHealthChanged.Broadcast(this, Health, -HealAmount, nullptr, nullptr, nullptr);
 }
 
 
+void USHealthComponent::RecordTelemetry(const UDamageType* DamageType, AController* InstigatedBy, float Amount)
+{
+	if (!FDamageTelemetry::IsEnabled())
+	{
+		return;
+	}
+
+	ACooperativeAIGameMode* MyGameMode = Cast<ACooperativeAIGameMode>(GetWorld()->GetAuthGameMode());
+	if (MyGameMode)
+	{
+		MyGameMode->GetDamageTelemetry().Record(GetOwner(), InstigatedBy, DamageType, Amount, Health);
+	}
+}
+
+
+void USHealthComponent::ResetHealth()
+{
+	Health = DefaultHealth;
+	bIsDead = false;
+}
+
+
 bool USHealthComponent::IsFriendly(AActor* ActorA, AActor* ActorB)
 {
 	if (ActorA == nullptr || ActorB == nullptr)
@@ -78,9 +127,12 @@ bool USHealthComponent::IsFriendly(AActor* ActorA, AActor* ActorB)
 		return true;
 	}
 
-	USHealthComponent* HealthCompA = Cast<USHealthComponent>(ActorA->GetComponentByClass(USHealthComponent::StaticClass()));
-	USHealthComponent* HealthCompB = Cast<USHealthComponent>(ActorB->GetComponentByClass(USHealthComponent::StaticClass()));
+	return IsFriendly(FindHealthComponent(ActorA), FindHealthComponent(ActorB));
+}
 
+
+bool USHealthComponent::IsFriendly(const USHealthComponent* HealthCompA, const USHealthComponent* HealthCompB)
+{
 	if (HealthCompA == nullptr || HealthCompB == nullptr)
 	{
 		// Assume friendly
@@ -91,6 +143,26 @@ bool USHealthComponent::IsFriendly(AActor* ActorA, AActor* ActorB)
 }
 
 
+USHealthComponent* USHealthComponent::FindHealthComponent(const AActor* Actor)
+{
+	if (Actor == nullptr)
+	{
+		return nullptr;
+	}
+
+	// Clients and actors that have not begun play yet are not in the registry
+	UWorld* World = Actor->GetWorld();
+	ACooperativeAIGameMode* MyGameMode = World ? Cast<ACooperativeAIGameMode>(World->GetAuthGameMode()) : nullptr;
+	USHealthComponent* HealthComp = MyGameMode ? MyGameMode->GetTeamRegistry().Find(Actor) : nullptr;
+	if (HealthComp)
+	{
+		return HealthComp;
+	}
+
+	return Actor->FindComponentByClass<USHealthComponent>();
+}
+
+
 float USHealthComponent::GetHealth() const
 {
 	return Health;
@@ -25,6 +25,11 @@ protected:
 	// Called when the game starts
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	// Team registry of the world's game mode, null on clients
+	class FTeamRegistry* GetTeamRegistry() const;
+
 	bool bIsDead;
 
 	UPROPERTY(BlueprintReadOnly, Category = "HealthComponent")
@@ -36,6 +41,9 @@ protected:
 	UFUNCTION()
 		void HandleTakeAnyDamage(AActor* DamagedActor, float Damage, const class UDamageType* DamageType, class AController* InstigatedBy, AActor* DamageCauser);
 
+	// Hands the health change to the game mode's damage telemetry, when enabled
+	void RecordTelemetry(const class UDamageType* DamageType, class AController* InstigatedBy, float Amount);
+
 public:
 
 	float GetHealth() const;
@@ -46,6 +54,15 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "HealthComponent")
 		void Heal(float HealAmount);
 
+	// Back to full health and alive, without broadcasting OnHealthChanged. Used by pooled actors
+	void ResetHealth();
+
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "HealthComponent")
 		static bool IsFriendly(AActor* ActorA, AActor* ActorB);
+
+	// Same test on components already at hand, without looking them up
+	static bool IsFriendly(const USHealthComponent* HealthCompA, const USHealthComponent* HealthCompB);
+
+	// The actor's health component, from the team registry when there is one
+	static USHealthComponent* FindHealthComponent(const AActor* Actor);
 };
@@ -1,17 +1,20 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "STrackerBot.h"
+#include "CooperativeAI.h"
 #include "Components/StaticMeshComponent.h"
 #include "Kismet/GameplayStatics.h"
 #include "AI/Navigation/NavigationSystem.h"
 #include "GameFramework/Character.h"
 #include "AI/Navigation/NavigationPath.h"
+#include "AI/Navigation/NavigationData.h"
 #include "DrawDebugHelpers.h"
 #include "SHealthComponent.h"
 #include "CooperativeAIGameMode.h"
 #include "CooperativeAICharacter.h"
-#include "Components/SphereComponent.h"
 #include "Sound/SoundCue.h"
+#include "GameFramework/PlayerController.h"
+#include "Engine/World.h"
 
 static int32 DebugTrackerBotDrawing = 0;
 FAutoConsoleVariableRef CVARDebugTrackerBotDrawing(
@@ -20,6 +23,9 @@ FAutoConsoleVariableRef CVARDebugTrackerBotDrawing(
 	TEXT("Draw Debug Lines for TrackerBot"),
 	ECVF_Cheat);
 
+DECLARE_CYCLE_STAT(TEXT("Path Query Start"), STAT_PathQueryStart, STATGROUP_COOP);
+DECLARE_CYCLE_STAT(TEXT("GetNextPathPoint"), STAT_GetNextPathPoint, STATGROUP_COOP);
+
 
 // Sets default values
 ASTrackerBot::ASTrackerBot()
@@ -35,16 +41,15 @@ ASTrackerBot::ASTrackerBot()
 	HealthComp = CreateDefaultSubobject<USHealthComponent>(TEXT("HealthComp"));
 	HealthComp->OnHealthChanged.AddDynamic(this, &ASTrackerBot::HandleTakeDamage);
 
-	SphereComp = CreateDefaultSubobject<USphereComponent>(TEXT("SphereComp"));
-	SphereComp->SetSphereRadius(200);
-	SphereComp->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
-	SphereComp->SetCollisionResponseToAllChannels(ECR_Ignore);
-	SphereComp->SetCollisionResponseToChannel(ECC_Pawn, ECR_Overlap);
-	SphereComp->SetupAttachment(RootComponent);
+	// Players are found by the game mode's proximity pass, overlaps would only pair the bots with each other
+	MeshComp->bGenerateOverlapEvents = false;
 
 	bUseVelocityChange = false;
 	MovementForce = 500;
 	RequiredDistanceToTarget = 100;
+	ProximityRadius = 200.0f;
+	bDetectPlayers = true;
+	AttackApproachDistance = 360.0f;
 
 	ExplosionDamage = 0.1f;
 	ExplosionRadius = 250;
@@ -52,7 +57,26 @@ ASTrackerBot::ASTrackerBot()
 	SelfDamageInterval = 0.25f;
 	AttackAngle = 0.0f;
 	BestLocalAngle = 0.0f;
+	SubSwarmIndex = INDEX_NONE;
 	bIsAngled = false;
+	RegistryIndex = INDEX_NONE;
+	RegistryState = ETrackerBotState::Alive;
+	bAwaitingInitialPath = false;
+	bPathQueued = false;
+	bPathQueryAngled = false;
+	PendingPathQuery = INVALID_NAVQUERYID;
+	bIsPooled = false;
+	MeshCollision = ECollisionEnabled::QueryAndPhysics;
+	LODTier = ETrackerBotLOD::Count;
+	PathRefreshInterval = 5.0f;
+	MovementInterval = 0.0f;
+	MovementTimeAccumulated = 0.0f;
+	bKinematic = false;
+	KinematicVelocity = FVector::ZeroVector;
+	KinematicGroundOffset = 0.0f;
+	KinematicAcceleration = 1000.0f;
+	KinematicMaxSpeed = 600.0f;
+	KinematicDamping = 0.5f;
 }
 
 // Called when the game starts or when spawned
@@ -60,9 +84,302 @@ void ASTrackerBot::BeginPlay()
 {
 	Super::BeginPlay();
 
-	// Find initial move-to
-	NextPathPoint = GetNextPathPoint();
+	MeshCollision = MeshComp->GetCollisionEnabled();
+	KinematicGroundOffset = MeshComp->Bounds.BoxExtent.Z;
+
+	StartLife();
+}
+
+
+void ASTrackerBot::StartLife()
+{
+	FTrackerBotRegistry* Registry = GetRegistry();
+	if (Registry)
+	{
+		Registry->Register(this);
+	}
+
+	// The game mode's movement manager steers the bot, its own tick is only a fallback
+	ACooperativeAIGameMode* MyGameMode = Cast<ACooperativeAIGameMode>(GetWorld()->GetAuthGameMode());
+	SetActorTickEnabled(MyGameMode == nullptr);
+	MovementTimeAccumulated = 0.0f;
+
+	// Find initial move-to, the bot waits where it spawned until the path queue answers
+	bAwaitingInitialPath = true;
+	NextPathPoint = GetActorLocation();
+	RequestNextPath();
+}
+
+
+void ASTrackerBot::DeactivateForPool()
+{
+	bIsPooled = true;
+
+	// Answers to queries started before the bot was pooled are ignored
+	bPathQueued = false;
+	PendingPathQuery = INVALID_NAVQUERYID;
+
+	FTrackerBotRegistry* Registry = GetRegistry();
+	if (Registry)
+	{
+		Registry->Unregister(this);
+	}
+
+	GetWorldTimerManager().ClearAllTimersForObject(this);
+	SetActorTickEnabled(false);
+
+	MeshComp->SetSimulatePhysics(false);
+	MeshComp->SetVisibility(false, true);
+	MeshComp->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+}
+
+
+void ASTrackerBot::ResetForReuse(const FTransform& SpawnTransform)
+{
+	bIsPooled = false;
+	bKinematic = false;
+	KinematicVelocity = FVector::ZeroVector;
+	bExploded = false;
+	bStartedSelfDestruction = false;
+	bIsAngled = false;
+	AttackAngle = 0.0f;
+	BestLocalAngle = 0.0f;
+	SubSwarmIndex = INDEX_NONE;
+
+	FTrackerBotRegistry* Registry = GetRegistry();
+	if (Registry)
+	{
+		Registry->SetState(this, ETrackerBotState::Alive);
+	}
+	else
+	{
+		RegistryState = ETrackerBotState::Alive;
+	}
+
+	HealthComp->ResetHealth();
+
+	if (MatInst)
+	{
+		MatInst->ClearParameterValues();
+	}
+
+	SetActorTransform(SpawnTransform, false, nullptr, ETeleportType::TeleportPhysics);
+
+	MeshComp->SetVisibility(true, true);
+	MeshComp->SetCollisionEnabled(MeshCollision);
+	MeshComp->SetSimulatePhysics(true);
+	MeshComp->SetPhysicsLinearVelocity(FVector::ZeroVector);
+	MeshComp->SetPhysicsAngularVelocity(FVector::ZeroVector);
+	bDetectPlayers = true;
+	SetActorTickEnabled(true);
+
+	// Full detail until the next significance pass
+	LODTier = ETrackerBotLOD::Count;
+	PathRefreshInterval = 5.0f;
+	MovementInterval = 0.0f;
+
+	StartLife();
+}
+
+
+void ASTrackerBot::SetLODTier(ETrackerBotLOD NewTier, const FTrackerBotLODSettings& Settings)
+{
+	if (NewTier == LODTier || bIsPooled)
+	{
+		return;
+	}
+
+	LODTier = NewTier;
+	MovementInterval = Settings.MovementInterval;
+	PathRefreshInterval = Settings.PathRefreshInterval;
+	bDetectPlayers = Settings.bDetectPlayers;
+}
+
+
+void ASTrackerBot::ReturnToPool()
+{
+	ACooperativeAIGameMode* MyGameMode = Cast<ACooperativeAIGameMode>(GetWorld()->GetAuthGameMode());
+	if (MyGameMode)
+	{
+		MyGameMode->ReleaseBot(this);
+	}
+	else
+	{
+		Destroy();
+	}
+}
+
+
+void ASTrackerBot::RequestNextPath()
+{
+	ACooperativeAIGameMode* MyGameMode = Cast<ACooperativeAIGameMode>(GetWorld()->GetAuthGameMode());
+	if (MyGameMode)
+	{
+		// The shared flow field around the target first, a path query only where the fields do not reach
+		if (FollowFlowField(MyGameMode->GetFlowFields()))
+		{
+			bAwaitingInitialPath = false;
+
+			// Try again later should the step not be reached
+			GetWorldTimerManager().SetTimer(TimerHandle_RefreshPath, this, &ASTrackerBot::RefreshPath, PathRefreshInterval, false);
+			return;
+		}
+
+		MyGameMode->GetPathQueue().RequestPath(this);
+	}
+	else
+	{
+		bAwaitingInitialPath = false;
+		NextPathPoint = GetNextPathPoint();
+	}
+}
+
+
+bool ASTrackerBot::FollowFlowField(const FTrackerBotFlowFields& FlowFields)
+{
+	APawn* BestTarget = FindBestTarget();
+	if (BestTarget == nullptr || !FlowFields.CanReach(BestTarget, GetActorLocation()))
+	{
+		return false;
+	}
+
+	if (!bIsAngled)
+	{
+		if (FlowFields.GetStepTowards(BestTarget, GetActorLocation(), GetAngledTargetLocation(BestTarget), NextPathPoint))
+		{
+			return true;
+		}
+
+		// At the attack angle, or it cannot be reached from here: go straight for the target
+		bIsAngled = true;
+	}
+
+	return FlowFields.GetNextStep(BestTarget, GetActorLocation(), NextPathPoint);
+}
+
+
+bool ASTrackerBot::StartPathQuery(FTrackerBotPathQueue& PathQueue)
+{
+	COOP_SCOPE_CYCLE_COUNTER(STAT_PathQueryStart, PathQuery);
+
+	bPathQueued = false;
+
+	if (bIsPooled || bExploded)
+	{
+		return false;
+	}
+
+	APawn* BestTarget = FindBestTarget();
+
+	UNavigationSystem* NavSys = GetWorld()->GetNavigationSystem();
+	const ANavigationData* NavData = NavSys ? NavSys->GetNavDataForProps(GetNavAgentPropertiesRef()) : nullptr;
+
+	if (BestTarget == nullptr || NavData == nullptr)
+	{
+		// Failed to find path
+		bAwaitingInitialPath = false;
+		NextPathPoint = GetActorLocation();
+		return false;
+	}
+
+	GetWorldTimerManager().SetTimer(TimerHandle_RefreshPath, this, &ASTrackerBot::RefreshPath, PathRefreshInterval, false);
+
+	// Head for the attack angle first, straight for the target once there or when it cannot be reached
+	bPathQueryAngled = !bIsAngled;
+	const FVector PathEnd = bPathQueryAngled ? GetAngledTargetLocation(BestTarget) : BestTarget->GetActorLocation();
+
+	// Bots sharing an approach share its path
+	const FTrackerBotPathKey Key = PathQueue.MakeKey(BestTarget, AttackAngle, bPathQueryAngled, GetActorLocation());
+	if (PathQueue.FindCachedPath(Key, BestTarget->GetActorLocation(), this))
+	{
+		return false;
+	}
+
+	FPathFindingQuery Query(this, *NavData, GetActorLocation(), PathEnd);
+	PendingPathQuery = NavSys->FindPathAsync(GetNavAgentPropertiesRef(), Query, FNavPathQueryDelegate::CreateUObject(this, &ASTrackerBot::OnPathFound));
+
+	if (PendingPathQuery != INVALID_NAVQUERYID)
+	{
+		PathQueue.AddPendingQuery(Key, PendingPathQuery, BestTarget->GetActorLocation());
+	}
+
+	return true;
+}
+
+
+void ASTrackerBot::OnPathFound(uint32 QueryID, ENavigationQueryResult::Type Result, FNavPathSharedPtr Path)
+{
+	// The bots waiting on the same path are answered as well, even if this one moved on
+	ACooperativeAIGameMode* MyGameMode = Cast<ACooperativeAIGameMode>(GetWorld()->GetAuthGameMode());
+	if (MyGameMode)
+	{
+		MyGameMode->GetPathQueue().OnPathFound(QueryID, Result, Path);
+	}
+
+	ReceivePath(QueryID, Result, Path);
+}
+
+
+void ASTrackerBot::ReceivePath(uint32 QueryID, ENavigationQueryResult::Type Result, FNavPathSharedPtr Path)
+{
+	// Answer to a query that was replaced since, or started before the bot was pooled
+	if (QueryID != PendingPathQuery)
+	{
+		return;
+	}
+
+	PendingPathQuery = INVALID_NAVQUERYID;
+
+	FollowPath(Result, Path);
+}
+
+
+void ASTrackerBot::FollowPath(ENavigationQueryResult::Type Result, FNavPathSharedPtr Path)
+{
+	if (Result == ENavigationQueryResult::Success && Path.IsValid() && Path->GetPathPoints().Num() > 1)
+	{
+		// The path may start anywhere in our start cell, carry on from the point after the nearest one
+		const TArray<FNavPathPoint>& PathPoints = Path->GetPathPoints();
+		int32 NearestPoint = 0;
+		float NearestDistance = FLT_MAX;
+		for (int32 PointIndex = 0; PointIndex < PathPoints.Num() - 1; PointIndex++)
+		{
+			const float Distance = FVector::DistSquared(PathPoints[PointIndex].Location, GetActorLocation());
+			if (Distance < NearestDistance)
+			{
+				NearestPoint = PointIndex;
+				NearestDistance = Distance;
+			}
+		}
+
+		// Next point in the path
+		bAwaitingInitialPath = false;
+		NextPathPoint = PathPoints[NearestPoint + 1].Location;
+		return;
+	}
+
+	if (bPathQueryAngled)
+	{
+		bIsAngled = true;
+		RequestNextPath();
+		return;
+	}
 
+	// Failed to find path
+	bAwaitingInitialPath = false;
+	NextPathPoint = GetActorLocation();
+}
+
+
+void ASTrackerBot::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	FTrackerBotRegistry* Registry = GetRegistry();
+	if (Registry)
+	{
+		Registry->Unregister(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 
@@ -81,30 +398,39 @@ void ASTrackerBot::HandleTakeDamage(USHealthComponent* OwningHealthComp, float H
 	// Explode on hitpoints == 0
 	if (Health <= 0.0f)
 	{
-		ACooperativeAIGameMode* MyGameMode = (ACooperativeAIGameMode*)GetWorld()->GetAuthGameMode();
+		ACooperativeAIGameMode* MyGameMode = Cast<ACooperativeAIGameMode>(GetWorld()->GetAuthGameMode());
+		if (MyGameMode)
+		{
+			MyGameMode->NotifyBotKilled(SubSwarmIndex, AttackAngle);
+		}
 
-		MyGameMode->AnglesDamaged.Add(AttackAngle, false);
 		SelfDestruct();
 	}
 }
 
 
-FVector ASTrackerBot::GetNextPathPoint()
+APawn* ASTrackerBot::FindBestTarget()
 {
-	AActor* BestTarget = nullptr;
+	// The game mode indexes the alive players, the pawn walk below is only for worlds without it
+	ACooperativeAIGameMode* MyGameMode = Cast<ACooperativeAIGameMode>(GetWorld()->GetAuthGameMode());
+	if (MyGameMode)
+	{
+		return MyGameMode->FindNearestTarget(GetActorLocation(), HealthComp->TeamNum);
+	}
+
+	APawn* BestTarget = nullptr;
 	float NearestTargetDistance = FLT_MAX;
 
 	for (FConstPawnIterator It = GetWorld()->GetPawnIterator(); It; ++It)
 	{
 		APawn* TestPawn = It->Get();
-		if (TestPawn == nullptr || USHealthComponent::IsFriendly(TestPawn, this))
+		USHealthComponent* TestPawnHealthComp = USHealthComponent::FindHealthComponent(TestPawn);
+		if (TestPawn == nullptr || USHealthComponent::IsFriendly(TestPawnHealthComp, HealthComp))
 		{
 			continue;
 		}
 
-
-		USHealthComponent* TestPawnHealthComp = Cast<USHealthComponent>(TestPawn->GetComponentByClass(USHealthComponent::StaticClass()));
-		if (TestPawnHealthComp && TestPawnHealthComp->GetHealth() > 0.0f)
+		if (TestPawnHealthComp->GetHealth() > 0.0f)
 		{
 			float Distance = (TestPawn->GetActorLocation() - GetActorLocation()).Size();
 
@@ -117,16 +443,31 @@ FVector ASTrackerBot::GetNextPathPoint()
 
 	}
 
+	return BestTarget;
+}
+
+
+FVector ASTrackerBot::GetAngledTargetLocation(AActor* Target) const
+{
+	// AttackAngle is a yaw around the target, 0 being in front of it
+	FVector ForwardVector = Target->GetActorForwardVector();
+	const FRotator Rotation(0.0f, AttackAngle, 0.0f);
+	FVector AngledVector = Rotation.RotateVector(ForwardVector);
+
+	return Target->GetActorLocation() + AngledVector * AttackApproachDistance;
+}
+
+
+FVector ASTrackerBot::GetNextPathPoint()
+{
+	// Only runs without the game mode's path queue, so it has a stat but no wave report column
+	SCOPE_CYCLE_COUNTER(STAT_GetNextPathPoint);
+
+	APawn* BestTarget = FindBestTarget();
 
 	if (BestTarget)
 	{
-		
-		FVector ForwardVector = BestTarget->GetActorForwardVector();
-		const FRotator Rotation(0.0f, 0.0f, AttackAngle);
-		FVector AngledVector = Rotation.RotateVector(ForwardVector);
-
-		FVector TargetAngledPosition = BestTarget->GetActorLocation() + AngledVector;
-		TargetAngledPosition *= 360.0f;
+		FVector TargetAngledPosition = GetAngledTargetLocation(BestTarget);
 
 		GetWorldTimerManager().ClearTimer(TimerHandle_RefreshPath);
 		GetWorldTimerManager().SetTimer(TimerHandle_RefreshPath, this, &ASTrackerBot::RefreshPath, 5.0f, false);
@@ -166,6 +507,12 @@ void ASTrackerBot::SelfDestruct()
 
 	bExploded = true;
 
+	FTrackerBotRegistry* Registry = GetRegistry();
+	if (Registry)
+	{
+		Registry->SetState(this, ETrackerBotState::Dead);
+	}
+
 	UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), ExplosionEffect, GetActorLocation());
 
 	UGameplayStatics::PlaySoundAtLocation(this, ExplodeSound, GetActorLocation());
@@ -173,19 +520,27 @@ void ASTrackerBot::SelfDestruct()
 	MeshComp->SetVisibility(false, true);
 	MeshComp->SetCollisionEnabled(ECollisionEnabled::NoCollision);
 
-	TArray<AActor*> IgnoredActors;
-	IgnoredActors.Add(this);
+	// Apply Damage! Batched with the other explosions of the frame by the game mode
+	ACooperativeAIGameMode* MyGameMode = Cast<ACooperativeAIGameMode>(GetWorld()->GetAuthGameMode());
+	if (MyGameMode)
+	{
+		MyGameMode->GetExplosions().QueueExplosion(GetActorLocation(), ExplosionDamage, ExplosionRadius, this, GetInstigatorController());
+	}
+	else
+	{
+		TArray<AActor*> IgnoredActors;
+		IgnoredActors.Add(this);
 
-	// Apply Damage!
-	UGameplayStatics::ApplyRadialDamage(this, ExplosionDamage, GetActorLocation(), ExplosionRadius, nullptr, IgnoredActors, this, GetInstigatorController(), true);
+		UGameplayStatics::ApplyRadialDamage(this, ExplosionDamage, GetActorLocation(), ExplosionRadius, nullptr, IgnoredActors, this, GetInstigatorController(), true);
+	}
 
 
 	if (DebugTrackerBotDrawing)
 	{
 		DrawDebugSphere(GetWorld(), GetActorLocation(), ExplosionRadius, 12, FColor::Red, false, 2.0f, 0, 1.0f);
 	}
-	SetLifeSpan(2.0f);
-	
+	// Linger for the explosion effects, then go back to the pool instead of being destroyed
+	GetWorldTimerManager().SetTimer(TimerHandle_ReturnToPool, this, &ASTrackerBot::ReturnToPool, 2.0f, false);
 }
 
 
@@ -200,18 +555,19 @@ void ASTrackerBot::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 
-	if (!bExploded)
+	// Only ticks without our game mode, which otherwise steers all bots and finds the players in range at once
+	if (CanTriggerOnPlayers())
+	{
+		CheckPlayersInRange();
+	}
+
+	if (IsMovementActive())
 	{
 		float DistanceToTarget = (GetActorLocation() - NextPathPoint).Size();
 
 		if (DistanceToTarget <= RequiredDistanceToTarget)
 		{
-			NextPathPoint = GetNextPathPoint();
-
-			if (DebugTrackerBotDrawing)
-			{
-				DrawDebugString(GetWorld(), GetActorLocation(), "Target Reached!");
-			}
+			OnPathPointReached();
 		}
 		else
 		{
@@ -221,51 +577,165 @@ void ASTrackerBot::Tick(float DeltaTime)
 
 			ForceDirection *= MovementForce;
 
-			MeshComp->AddForce(ForceDirection, NAME_None, bUseVelocityChange);
-			
-			if (DebugTrackerBotDrawing)
-			{
-				DrawDebugDirectionalArrow(GetWorld(), GetActorLocation(), GetActorLocation() + ForceDirection, 32, FColor::Yellow, false, 0.0f, 0, 1.0f);
-			}
+			ApplySteering(ForceDirection, DeltaTime);
 		}
+	}
+}
 
-		if (DebugTrackerBotDrawing)
-		{
-			DrawDebugSphere(GetWorld(), NextPathPoint, 20, 12, FColor::Yellow, false, 0.0f, 1.0f);
-		}
+
+void ASTrackerBot::OnPathPointReached()
+{
+	RequestNextPath();
+
+	if (DebugTrackerBotDrawing)
+	{
+		DrawDebugString(GetWorld(), GetActorLocation(), "Target Reached!");
+		DrawDebugSphere(GetWorld(), NextPathPoint, 20, 12, FColor::Yellow, false, 0.0f, 1.0f);
+	}
+}
+
+
+void ASTrackerBot::ApplySteering(const FVector& Force, float DeltaTime)
+{
+	if (bKinematic)
+	{
+		IntegrateKinematic(Force, DeltaTime);
+	}
+	// Updated less often than every frame, push for the whole time since the last update at once
+	else if (MovementInterval > 0.0f)
+	{
+		MeshComp->AddImpulse(Force * DeltaTime, NAME_None, bUseVelocityChange);
+	}
+	else
+	{
+		MeshComp->AddForce(Force, NAME_None, bUseVelocityChange);
+	}
+
+	if (DebugTrackerBotDrawing)
+	{
+		DrawDebugDirectionalArrow(GetWorld(), GetActorLocation(), GetActorLocation() + Force, 32, FColor::Yellow, false, 0.0f, 0, 1.0f);
+		DrawDebugSphere(GetWorld(), NextPathPoint, 20, 12, FColor::Yellow, false, 0.0f, 1.0f);
+	}
+}
+
+
+void ASTrackerBot::IntegrateKinematic(const FVector& Force, float DeltaTime)
+{
+	const FVector Acceleration = FVector(Force.X, Force.Y, 0.0f).GetSafeNormal() * KinematicAcceleration;
+
+	KinematicVelocity += Acceleration * DeltaTime;
+	KinematicVelocity *= FMath::Max(0.0f, 1.0f - KinematicDamping * DeltaTime);
+	KinematicVelocity = KinematicVelocity.GetClampedToMaxSize2D(KinematicMaxSpeed);
+	KinematicVelocity.Z = 0.0f;
+
+	const FVector Step = KinematicVelocity * DeltaTime;
+	FVector NewLocation = GetActorLocation() + Step;
+
+	// Stay on the navmesh: clamped to its nearest point, and no step at all where there is none nearby
+	UNavigationSystem* NavSys = UNavigationSystem::GetCurrent<UNavigationSystem>(this);
+	FNavLocation GroundLocation;
+	if (NavSys == nullptr || !NavSys->ProjectPointToNavigation(NewLocation, GroundLocation, FVector(KinematicGroundOffset, KinematicGroundOffset, 4.0f * KinematicGroundOffset + 100.0f)))
+	{
+		KinematicVelocity = FVector::ZeroVector;
+		return;
+	}
+	NewLocation = GroundLocation.Location + FVector(0.0f, 0.0f, KinematicGroundOffset);
+
+	// Roll the ball by the distance covered, like it would on the ground
+	FQuat NewRotation = GetActorQuat();
+	const float Distance = Step.Size();
+	if (Distance > KINDA_SMALL_NUMBER && KinematicGroundOffset > KINDA_SMALL_NUMBER)
+	{
+		const FVector RollAxis = FVector::CrossProduct(FVector::UpVector, Step / Distance);
+		NewRotation = FQuat(RollAxis, Distance / KinematicGroundOffset) * NewRotation;
+	}
+
+	// Swept, so walls, players and other bots stop the bot instead of being driven through
+	FHitResult Hit;
+	SetActorLocationAndRotation(NewLocation, NewRotation, true, &Hit, ETeleportType::TeleportPhysics);
+	if (Hit.bBlockingHit)
+	{
+		// Slide along what was hit from the next step on
+		KinematicVelocity = FVector::VectorPlaneProject(KinematicVelocity, Hit.Normal);
+		KinematicVelocity.Z = 0.0f;
 	}
 }
 
 
-void ASTrackerBot::NotifyActorBeginOverlap(AActor* OtherActor)
+void ASTrackerBot::SetKinematic(bool bNewKinematic)
 {
-	Super::NotifyActorBeginOverlap(OtherActor);
+	if (bNewKinematic == bKinematic || bIsPooled || bExploded)
+	{
+		return;
+	}
+
+	bKinematic = bNewKinematic;
+
+	if (bKinematic)
+	{
+		// Query collision only, so weapons still hit the bot without PhysX simulating a dynamic body for it
+		KinematicVelocity = MeshComp->GetPhysicsLinearVelocity();
+		MeshComp->SetSimulatePhysics(false);
+		MeshComp->SetCollisionEnabled(MeshCollision == ECollisionEnabled::NoCollision ? MeshCollision : ECollisionEnabled::QueryOnly);
+	}
+	else
+	{
+		MeshComp->SetCollisionEnabled(MeshCollision);
+		MeshComp->SetSimulatePhysics(true);
+		MeshComp->SetPhysicsLinearVelocity(KinematicVelocity);
+		KinematicVelocity = FVector::ZeroVector;
+	}
+}
+
 
+void ASTrackerBot::OnPlayerInRange(APawn* Player)
+{
 	if (!bStartedSelfDestruction && !bExploded)
 	{
-		ACooperativeAICharacter * PlayerPawn = Cast<ACooperativeAICharacter>(OtherActor);
-		if (PlayerPawn && !USHealthComponent::IsFriendly(OtherActor, this))
+		ACooperativeAICharacter * PlayerPawn = Cast<ACooperativeAICharacter>(Player);
+		if (PlayerPawn && !USHealthComponent::IsFriendly(USHealthComponent::FindHealthComponent(Player), HealthComp))
 		{
-			// We overlapped with a player!
+			// We reached a player!
 
 			// Start self destruction sequence
 			GetWorldTimerManager().SetTimer(TimerHandle_SelfDamage, this, &ASTrackerBot::SelfDestruct, SelfDamageInterval, true, 0.0f);	
 
 			bStartedSelfDestruction = true;
 
-			ACooperativeAIGameMode* MyGameMode = (ACooperativeAIGameMode*)GetWorld()->GetAuthGameMode();
-
-			MyGameMode->AnglesDamaged.Add(AttackAngle, true);
-			float PreviousHits = MyGameMode->HitAngles[AttackAngle];
-			MyGameMode->HitAngles.Add(AttackAngle, (PreviousHits + 1.0f));
+			ACooperativeAIGameMode* MyGameMode = Cast<ACooperativeAIGameMode>(GetWorld()->GetAuthGameMode());
+			if (MyGameMode)
+			{
+				MyGameMode->NotifyBotHitPlayer(SubSwarmIndex, AttackAngle);
+				MyGameMode->GetBotRegistry().SetState(this, ETrackerBotState::Exploding);
+			}
 
 			UGameplayStatics::SpawnSoundAttached(SelfDestructSound, RootComponent);
 		}
 	}
 }
 
+
+void ASTrackerBot::CheckPlayersInRange()
+{
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		APawn* Player = It->Get() ? It->Get()->GetPawn() : nullptr;
+		if (Player && FVector::DistSquared(Player->GetActorLocation(), GetActorLocation()) <= FMath::Square(ProximityRadius))
+		{
+			OnPlayerInRange(Player);
+		}
+	}
+}
+
 void ASTrackerBot::RefreshPath()
 {
-	NextPathPoint = GetNextPathPoint();
+	RequestNextPath();
 }
 
+
+FTrackerBotRegistry* ASTrackerBot::GetRegistry() const
+{
+	UWorld* World = GetWorld();
+	ACooperativeAIGameMode* MyGameMode = World ? Cast<ACooperativeAIGameMode>(World->GetAuthGameMode()) : nullptr;
+	return MyGameMode ? &MyGameMode->GetBotRegistry() : nullptr;
+}
@@ -4,11 +4,15 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Pawn.h"
+#include "TrackerBotRegistry.h"
+#include "TrackerBotSignificance.h"
+#include "AI/Navigation/NavigationTypes.h"
 #include "STrackerBot.generated.h"
 
 class USHealthComponent;
-class USphereComponent;
 class USoundCue;
+class FTrackerBotFlowFields;
+class FTrackerBotPathQueue;
 
 UCLASS()
 class ASTrackerBot : public APawn
@@ -23,24 +27,59 @@ protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	UPROPERTY(VisibleDefaultsOnly, Category = "Components")
 		UStaticMeshComponent* MeshComp;
 
 	UPROPERTY(VisibleDefaultsOnly, Category = "Components")
 		USHealthComponent* HealthComp;
 
-	UPROPERTY(VisibleDefaultsOnly, Category = "Components")
-		USphereComponent* SphereComp;
-
 	UFUNCTION()
 		void HandleTakeDamage(USHealthComponent* OwningHealthComp, float Health, float HealthDelta, const class UDamageType* DamageType,
 			class AController* InstigatedBy, AActor* DamageCauser);
 
+	// Synchronous path query, only used when there is no game mode to queue the request with
 	FVector GetNextPathPoint();
 
+	// Nearest living player that is not on our team
+	APawn* FindBestTarget();
+
+	// Point around Target the bot approaches from before attacking
+	FVector GetAngledTargetLocation(AActor* Target) const;
+
+	// Takes the next step from the flow field around the target, false when the bot is outside of it
+	bool FollowFlowField(const FTrackerBotFlowFields& FlowFields);
+
 	// Next point in navigation path
 	FVector NextPathPoint;
 
+	// Spawned but no path answer has come back yet
+	bool bAwaitingInitialPath;
+
+	friend class FTrackerBotPathQueue;
+
+	// Waiting in the path queue
+	bool bPathQueued;
+
+	// Whether the query in flight heads for the attack angle rather than the target itself
+	bool bPathQueryAngled;
+
+	// Async navigation query in flight, INVALID_NAVQUERYID when none
+	uint32 PendingPathQuery;
+
+	// Called by the path queue when the request's turn comes, reuses a cached path or starts the async navigation query. True only when a navigation query was started
+	bool StartPathQuery(FTrackerBotPathQueue& PathQueue);
+
+	// Answer to the query this bot started
+	void OnPathFound(uint32 QueryID, ENavigationQueryResult::Type Result, FNavPathSharedPtr Path);
+
+	// Answer to the query this bot waits on, started by this bot or by another one with the same approach
+	void ReceivePath(uint32 QueryID, ENavigationQueryResult::Type Result, FNavPathSharedPtr Path);
+
+	// Heads for the next point of Path, or falls back when there is none
+	void FollowPath(ENavigationQueryResult::Type Result, FNavPathSharedPtr Path);
+
 	UPROPERTY(EditDefaultsOnly, Category = "TrackerBot")
 		float MovementForce;
 
@@ -50,6 +89,20 @@ protected:
 	UPROPERTY(EditDefaultsOnly, Category = "TrackerBot")
 		float RequiredDistanceToTarget;
 
+	// Distance to a player that starts the self destruct sequence
+	UPROPERTY(EditDefaultsOnly, Category = "TrackerBot")
+		float ProximityRadius;
+
+	// Whether the proximity pass looks for players around this bot, depends on the LOD tier
+	bool bDetectPlayers;
+
+	// Without a game mode, looks for players in range itself
+	void CheckPlayersInRange();
+
+	// Distance from the target of the point the bot approaches from along its AttackAngle
+	UPROPERTY(EditDefaultsOnly, Category = "TrackerBot")
+		float AttackApproachDistance;
+
 	// Dynamic material to pulse on damage
 	UMaterialInstanceDynamic* MatInst;
 
@@ -86,7 +139,13 @@ public:
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
 
-	virtual void NotifyActorBeginOverlap(AActor* OtherActor) override;
+	// Starts the self destruct sequence if Player is an enemy player
+	void OnPlayerInRange(APawn* Player);
+
+	// Hunting and close enough to the players for its LOD tier to look for them
+	bool CanTriggerOnPlayers() const { return bDetectPlayers && !bStartedSelfDestruction && !bExploded && !bIsPooled; }
+
+	float GetProximityRadius() const { return ProximityRadius; }
 
 	// Angle in degrees from which the bot will try to approach the players (0/360 is the direction a player is facing)
 	float AttackAngle;
@@ -94,13 +153,110 @@ public:
 	// Best angle observed by this actor ( Used in PSO )
 	float BestLocalAngle;
 
+	// Sub-swarm this bot learns with, INDEX_NONE until the game mode deals it into one
+	int32 SubSwarmIndex;
+
 	// Indicates whether the bot is in angled correctly to start attacking a player
 	bool bIsAngled;
 
+	// Asks the game mode's path queue for the next path point, coalesced with any request already pending
+	void RequestNextPath();
+
+	bool HasPathRequest() const { return bPathQueued || PendingPathQuery != INVALID_NAVQUERYID; }
+
+	// Parks the bot in the game mode's pool: hidden, without collision, physics, tick or timers
+	void DeactivateForPool();
+
+	// Brings a pooled bot back as if it had just been spawned at SpawnTransform
+	void ResetForReuse(const FTransform& SpawnTransform);
+
+	bool IsPooled() const { return bIsPooled; }
+
+	ETrackerBotState GetRegistryState() const { return RegistryState; }
+
+	ETrackerBotLOD GetLODTier() const { return LODTier; }
+
+	// Applies the tick interval, path refresh rate and player detection of a new LOD tier
+	void SetLODTier(ETrackerBotLOD NewTier, const FTrackerBotLODSettings& Settings);
+
+	// Switches between the physics simulated body and the kinematic integrator, keeping the bot's velocity
+	void SetKinematic(bool bNewKinematic);
+
+	bool IsKinematic() const { return bKinematic; }
+
 protected:
 
 
 	FTimerHandle TimerHandle_RefreshPath;
 
 	void RefreshPath();
+
+	// Registers with the game mode and queues the first path query, on spawn and on every reuse
+	void StartLife();
+
+	FTimerHandle TimerHandle_ReturnToPool;
+
+	// Hands the exploded bot back to the game mode's pool
+	void ReturnToPool();
+
+	// Waiting in the pool for the next wave
+	bool bIsPooled;
+
+	// Collision of the mesh when spawned, restored on reuse
+	ECollisionEnabled::Type MeshCollision;
+
+	// Set by the game mode's significance pass, Count until the first one
+	ETrackerBotLOD LODTier;
+
+	friend class FTrackerBotMovement;
+
+	// Seconds between two movement updates, depends on the LOD tier
+	float MovementInterval;
+
+	// Seconds since the last movement update
+	float MovementTimeAccumulated;
+
+	// Moving towards NextPathPoint
+	bool IsMovementActive() const { return !bExploded && !bAwaitingInitialPath && !bIsPooled; }
+
+	// Pushes the body with the steering force computed for the last DeltaTime seconds
+	void ApplySteering(const FVector& Force, float DeltaTime);
+
+	// Asks for the next path point
+	void OnPathPointReached();
+
+	// Moved by IntegrateKinematic instead of the physics simulation
+	bool bKinematic;
+
+	// Velocity integrated while kinematic, handed back to the body when physics takes over again
+	FVector KinematicVelocity;
+
+	// Distance from the navmesh to the bot's origin, from the mesh bounds
+	float KinematicGroundOffset;
+
+	// Rolls the bot towards the steering force with bounded acceleration and speed, then snaps it to the navmesh
+	void IntegrateKinematic(const FVector& Force, float DeltaTime);
+
+	UPROPERTY(EditDefaultsOnly, Category = "TrackerBot")
+		float KinematicAcceleration;
+
+	UPROPERTY(EditDefaultsOnly, Category = "TrackerBot")
+		float KinematicMaxSpeed;
+
+	// Fraction of the velocity lost per second while kinematic
+	UPROPERTY(EditDefaultsOnly, Category = "TrackerBot", meta = (ClampMin = 0, ClampMax = 1))
+		float KinematicDamping;
+
+	// Seconds before the path is refreshed when the next path point is not reached, depends on the LOD tier
+	float PathRefreshInterval;
+
+	// Registry of the world's game mode, null on clients
+	FTrackerBotRegistry* GetRegistry() const;
+
+	friend class FTrackerBotRegistry;
+
+	// Slot in the registry's dense array, INDEX_NONE when not registered
+	int32 RegistryIndex;
+
+	ETrackerBotState RegistryState;
 };
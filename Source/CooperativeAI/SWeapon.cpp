@@ -1,6 +1,7 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "SWeapon.h"
+#include "CooperativeAI.h"
 #include "DrawDebugHelpers.h"
 #include "Kismet/GameplayStatics.h"
 #include "Particles/ParticleSystem.h"
@@ -8,6 +9,8 @@
 #include "Particles/ParticleSystemComponent.h"
 #include "PhysicalMaterials/PhysicalMaterial.h"
 #include "TimerManager.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
 
 static int32 DebugWeaponDrawing = 0;
 FAutoConsoleVariableRef CVARDebugWeaponDrawing(
@@ -16,6 +19,8 @@ FAutoConsoleVariableRef CVARDebugWeaponDrawing(
 	TEXT("Draw Debug Lines for Weapons"), 
 	ECVF_Cheat);
 
+DECLARE_CYCLE_STAT(TEXT("Weapon Trace"), STAT_WeaponTrace, STATGROUP_COOP);
+
 
 // Sets default values
 ASWeapon::ASWeapon()
@@ -30,6 +35,9 @@ ASWeapon::ASWeapon()
 	BulletSpread = 1.0f;
 	RateOfFire = 600;
 
+	MaxTracerEffects = 4;
+	MaxImpactEffects = 8;
+	EffectCullDistance = 8000.0f;
 
 	NetUpdateFrequency = 66.0f;
 	MinNetUpdateFrequency = 33.0f;
@@ -44,6 +52,37 @@ void ASWeapon::BeginPlay()
 }
 
 
+void ASWeapon::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// The pooled effects are owned by the world, not by the weapon
+	if (MuzzleComp)
+	{
+		MuzzleComp->DestroyComponent();
+		MuzzleComp = nullptr;
+	}
+
+	for (UParticleSystemComponent* EffectComp : TracerPool)
+	{
+		if (EffectComp)
+		{
+			EffectComp->DestroyComponent();
+		}
+	}
+	TracerPool.Empty();
+
+	for (UParticleSystemComponent* EffectComp : ImpactPool)
+	{
+		if (EffectComp)
+		{
+			EffectComp->DestroyComponent();
+		}
+	}
+	ImpactPool.Empty();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+
 void ASWeapon::Fire()
 {
 	// Trace the world, from pawn eyes to crosshair location
@@ -75,7 +114,13 @@ void ASWeapon::Fire()
 		EPhysicalSurface SurfaceType = SurfaceType_Default;
 
 		FHitResult Hit;
-		if (GetWorld()->LineTraceSingleByChannel(Hit, EyeLocation, TraceEnd, ECC_GameTraceChannel1, QueryParams))
+		bool bBlockingHit;
+		{
+			COOP_SCOPE_CYCLE_COUNTER(STAT_WeaponTrace, WeaponTraces);
+			bBlockingHit = GetWorld()->LineTraceSingleByChannel(Hit, EyeLocation, TraceEnd, ECC_GameTraceChannel1, QueryParams);
+		}
+
+		if (bBlockingHit)
 		{
 			// Blocking hit! Process damage
 			AActor* HitActor = Hit.GetActor();
@@ -133,16 +178,24 @@ void ASWeapon::StopFire()
 
 void ASWeapon::PlayFireEffects(FVector TraceEnd)
 {
-	if (MuzzleEffect)
+	FVector MuzzleLocation = MeshComp->GetSocketLocation(MuzzleSocketName);
+
+	// Culled apart, a tracer fired into a player's view is seen even when the shooter is not
+	if (MuzzleEffect && ShouldPlayEffectAt(MuzzleLocation))
 	{
-		UGameplayStatics::SpawnEmitterAttached(MuzzleEffect, MeshComp, MuzzleSocketName);
+		if (MuzzleComp == nullptr)
+		{
+			MuzzleComp = UGameplayStatics::SpawnEmitterAttached(MuzzleEffect, MeshComp, MuzzleSocketName, FVector::ZeroVector, FRotator::ZeroRotator, EAttachLocation::KeepRelativeOffset, false);
+		}
+		else
+		{
+			MuzzleComp->ActivateSystem(true);
+		}
 	}
 
-	if (TracerEffect)
+	if (TracerEffect && ShouldPlayEffectAlong(MuzzleLocation, TraceEnd))
 	{
-		FVector MuzzleLocation = MeshComp->GetSocketLocation(MuzzleSocketName);
-
-		UParticleSystemComponent* TracerComp = UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), TracerEffect, MuzzleLocation);
+		UParticleSystemComponent* TracerComp = AcquireEffect(TracerPool, MaxTracerEffects, TracerEffect, MuzzleLocation, FRotator::ZeroRotator);
 		if (TracerComp)
 		{
 			TracerComp->SetVectorParameter(TracerTargetName, TraceEnd);
@@ -166,13 +219,90 @@ void ASWeapon::PlayImpactEffects(EPhysicalSurface SurfaceType, FVector ImpactPoi
 		break;
 	}
 
-	if (SelectedEffect)
+	if (SelectedEffect && ShouldPlayEffectAt(ImpactPoint))
 	{
 		FVector MuzzleLocation = MeshComp->GetSocketLocation(MuzzleSocketName);
 
 		FVector ShotDirection = ImpactPoint - MuzzleLocation;
 		ShotDirection.Normalize();
 
-		UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), SelectedEffect, ImpactPoint, ShotDirection.Rotation());
+		AcquireEffect(ImpactPool, MaxImpactEffects, SelectedEffect, ImpactPoint, ShotDirection.Rotation());
+	}
+}
+
+
+UParticleSystemComponent* ASWeapon::AcquireEffect(TArray<UParticleSystemComponent*>& Pool, int32 MaxActive, UParticleSystem* Template, const FVector& Location, const FRotator& Rotation)
+{
+	// Finished effects deactivate themselves and are free to play again
+	for (UParticleSystemComponent* EffectComp : Pool)
+	{
+		if (EffectComp && !EffectComp->IsActive())
+		{
+			if (EffectComp->Template != Template)
+			{
+				EffectComp->SetTemplate(Template);
+			}
+			EffectComp->SetWorldLocationAndRotation(Location, Rotation);
+			EffectComp->ActivateSystem(true);
+			return EffectComp;
+		}
+	}
+
+	Pool.Remove(nullptr);
+	if (Pool.Num() >= MaxActive)
+	{
+		return nullptr;
+	}
+
+	UParticleSystemComponent* EffectComp = UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), Template, Location, Rotation, false);
+	if (EffectComp)
+	{
+		Pool.Add(EffectComp);
+	}
+	return EffectComp;
+}
+
+
+bool ASWeapon::ShouldPlayEffectAt(const FVector& Location) const
+{
+	return ShouldPlayEffectAlong(Location, Location);
+}
+
+
+bool ASWeapon::ShouldPlayEffectAlong(const FVector& Start, const FVector& End) const
+{
+	// Nobody watches a dedicated server
+	if (GetNetMode() == NM_DedicatedServer)
+	{
+		return false;
 	}
-}
\ No newline at end of file
+
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		APlayerController* PC = It->Get();
+		if (PC == nullptr || !PC->IsLocalController())
+		{
+			continue;
+		}
+
+		FVector ViewLocation;
+		FRotator ViewRotation;
+		PC->GetPlayerViewPoint(ViewLocation, ViewRotation);
+
+		// Distance to the nearest point of the effect
+		const FVector ToEffect = FMath::ClosestPointOnSegment(ViewLocation, Start, End) - ViewLocation;
+		if (ToEffect.SizeSquared() > FMath::Square(EffectCullDistance))
+		{
+			continue;
+		}
+
+		// Either end in front of the view, or close enough for its particles to reach the screen
+		const FVector ViewDirection = ViewRotation.Vector();
+		if (((Start - ViewLocation) | ViewDirection) > 0.0f || ((End - ViewLocation) | ViewDirection) > 0.0f || ToEffect.SizeSquared() < FMath::Square(500.0f))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
@@ -9,6 +9,7 @@
 class USkeletalMeshComponent;
 class UDamageType;
 class UParticleSystem;
+class UParticleSystemComponent;
 
 // Contains information of a single hitscan weapon linetrace
 USTRUCT()
@@ -39,6 +40,8 @@ protected:
 
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
 	USkeletalMeshComponent* MeshComp;
 
@@ -88,6 +91,37 @@ protected:
 
 	FHitScanTrace HitScanTrace;
 
+	/* Most tracers of this weapon playing at once, shots over the cap play none */
+	UPROPERTY(EditDefaultsOnly, Category = "Weapon", meta = (ClampMin = 0))
+	int32 MaxTracerEffects;
+
+	/* Most impacts of this weapon playing at once, shots over the cap play none */
+	UPROPERTY(EditDefaultsOnly, Category = "Weapon", meta = (ClampMin = 0))
+	int32 MaxImpactEffects;
+
+	/* Effects further than this from every local view, or behind all of them, are skipped */
+	UPROPERTY(EditDefaultsOnly, Category = "Weapon", meta = (ClampMin = 0.0f))
+	float EffectCullDistance;
+
+	// Reused for every shot instead of spawning a new component
+	UPROPERTY()
+	UParticleSystemComponent* MuzzleComp;
+
+	UPROPERTY()
+	TArray<UParticleSystemComponent*> TracerPool;
+
+	UPROPERTY()
+	TArray<UParticleSystemComponent*> ImpactPool;
+
+	// Returns an idle component of the pool playing Template at Location, nullptr when MaxActive are already playing
+	UParticleSystemComponent* AcquireEffect(TArray<UParticleSystemComponent*>& Pool, int32 MaxActive, UParticleSystem* Template, const FVector& Location, const FRotator& Rotation);
+
+	// Whether an effect at Location can be seen by any local player
+	bool ShouldPlayEffectAt(const FVector& Location) const;
+
+	// Whether an effect spanning Start to End, like a tracer, can be seen by any local player
+	bool ShouldPlayEffectAlong(const FVector& Start, const FVector& End) const;
+
 	UFUNCTION()
 	void OnRep_HitScanTrace();
 
@@ -0,0 +1,63 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SwarmAliasTable.h"
+
+
+void FSwarmAliasTable::Build(const float* Weights, int32 Num)
+{
+	Probability.SetNumUninitialized(Num);
+	Alias.SetNumUninitialized(Num);
+	Scaled.SetNumUninitialized(Num);
+	Small.Reset(Num);
+	Large.Reset(Num);
+
+	float Total = 0.0f;
+	for (int32 Index = 0; Index < Num; Index++)
+	{
+		Total += Weights[Index];
+	}
+
+	// Every column holds an average weight of 1 after scaling
+	const float Scale = Total > 0.0f ? Num / Total : 0.0f;
+	for (int32 Index = 0; Index < Num; Index++)
+	{
+		Scaled[Index] = Total > 0.0f ? Weights[Index] * Scale : 1.0f;
+		Alias[Index] = Index;
+
+		if (Scaled[Index] < 1.0f)
+		{
+			Small.Add(Index);
+		}
+		else
+		{
+			Large.Add(Index);
+		}
+	}
+
+	// Pair each under-full column with an over-full one that tops it up
+	while (Small.Num() > 0 && Large.Num() > 0)
+	{
+		int32 Less = Small.Pop(false);
+		int32 More = Large.Last();
+
+		Probability[Less] = Scaled[Less];
+		Alias[Less] = More;
+
+		Scaled[More] = (Scaled[More] + Scaled[Less]) - 1.0f;
+		if (Scaled[More] < 1.0f)
+		{
+			Large.Pop(false);
+			Small.Add(More);
+		}
+	}
+
+	// Whatever is left is full up to rounding error
+	for (int32 Index : Large)
+	{
+		Probability[Index] = 1.0f;
+	}
+	for (int32 Index : Small)
+	{
+		Probability[Index] = 1.0f;
+	}
+}
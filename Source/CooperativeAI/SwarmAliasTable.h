@@ -0,0 +1,39 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Walker alias table for roulette-wheel selection.
+ * Building it is O(n) once per wave, every draw afterwards is O(1) and always returns a valid index.
+ */
+struct FSwarmAliasTable
+{
+	// Builds the table from non negative weights, they do not need to be normalized
+	void Build(const float* Weights, int32 Num);
+
+	// Draws an index with probability proportional to its weight from a uniform number in [0, 1)
+	FORCEINLINE int32 Sample(float Uniform) const
+	{
+		const int32 Num = Probability.Num();
+		const float Scaled = Uniform * Num;
+		const int32 Column = FMath::Min(FMath::TruncToInt(Scaled), Num - 1);
+		return (Scaled - Column) < Probability[Column] ? Column : Alias[Column];
+	}
+
+	int32 Num() const { return Probability.Num(); }
+
+protected:
+
+	// Chance of keeping each column instead of jumping to its alias
+	TArray<float> Probability;
+
+	// Index taking over the remaining share of each column
+	TArray<int32> Alias;
+
+	// Worklists reused between builds so a wave does not allocate
+	TArray<int32> Small;
+	TArray<int32> Large;
+	TArray<float> Scaled;
+};
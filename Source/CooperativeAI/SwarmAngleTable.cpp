@@ -0,0 +1,75 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SwarmAngleTable.h"
+#include "Math/VectorRegister.h"
+
+
+void FSwarmAngleTable::Initialize(int32 InNumAngles)
+{
+	NumAngles = FMath::Max(InNumAngles, 1);
+	AngleStep = 360.0f / NumAngles;
+
+	Angles.SetNumUninitialized(NumAngles);
+	for (int32 AngleIndex = 0; AngleIndex < NumAngles; AngleIndex++)
+	{
+		Angles[AngleIndex] = AngleIndex * AngleStep;
+	}
+
+	LocalBestAngles = Angles;
+
+	Damaged.Init(0.0f, NumAngles);
+	Pheromones.Init(1.0f, NumAngles); // Pheromone set initially to 1.0 to avoid division by zero in selection probabilities
+	Hits.Init(0.0f, NumAngles);
+}
+
+
+float FSwarmKernels::EvaporateAndDeposit(float* RESTRICT Pheromones, const float* RESTRICT Damaged, int32 Num, float EvaporationRate)
+{
+	const float Retained = 1.0f - EvaporationRate;
+	const VectorRegister RetainedVec = VectorSetFloat1(Retained);
+	VectorRegister TotalVec = VectorZero();
+
+	int32 Index = 0;
+	for (; Index + 4 <= Num; Index += 4)
+	{
+		VectorRegister Pheromone = VectorMultiplyAdd(VectorLoad(Pheromones + Index), RetainedVec, VectorLoad(Damaged + Index));
+		VectorStore(Pheromone, Pheromones + Index);
+		TotalVec = VectorAdd(TotalVec, Pheromone);
+	}
+
+	float Lanes[4];
+	VectorStore(TotalVec, Lanes);
+	float Total = Lanes[0] + Lanes[1] + Lanes[2] + Lanes[3];
+
+	for (; Index < Num; Index++)
+	{
+		Pheromones[Index] = Pheromones[Index] * Retained + Damaged[Index];
+		Total += Pheromones[Index];
+	}
+
+	return Total;
+}
+
+
+void FSwarmKernels::ParticleSwarmStep(float* RESTRICT OutAngles, const float* RESTRICT Angles, const float* RESTRICT BestLocal,
+	const float* RESTRICT RandomLocal, const float* RESTRICT RandomGlobal, int32 Num,
+	float ConstantWeight, float LocalWeight, float GlobalWeight, float BestGlobalAngle)
+{
+	const VectorRegister ConstantVec = VectorSetFloat1(ConstantWeight);
+	const VectorRegister LocalVec = VectorSetFloat1(LocalWeight);
+	const VectorRegister GlobalVec = VectorSetFloat1(GlobalWeight * BestGlobalAngle);
+
+	int32 Index = 0;
+	for (; Index + 4 <= Num; Index += 4)
+	{
+		VectorRegister NewAngle = VectorMultiply(ConstantVec, VectorLoad(Angles + Index));
+		NewAngle = VectorMultiplyAdd(VectorMultiply(LocalVec, VectorLoad(RandomLocal + Index)), VectorLoad(BestLocal + Index), NewAngle);
+		NewAngle = VectorMultiplyAdd(GlobalVec, VectorLoad(RandomGlobal + Index), NewAngle);
+		VectorStore(NewAngle, OutAngles + Index);
+	}
+
+	for (; Index < Num; Index++)
+	{
+		OutAngles[Index] = (ConstantWeight * Angles[Index]) + (LocalWeight * RandomLocal[Index] * BestLocal[Index]) + (GlobalWeight * RandomGlobal[Index] * BestGlobalAngle);
+	}
+}
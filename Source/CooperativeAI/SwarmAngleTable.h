@@ -0,0 +1,68 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Everything the swarm learned about the attack angles, stored as dense columns indexed by angle bucket.
+ * Bucket i covers the angle i * AngleStep, lookups from an angle are a single division instead of a float hash.
+ */
+struct FSwarmAngleTable
+{
+	// Number of angle buckets around the player
+	int32 NumAngles;
+
+	// Degrees between two neighbouring buckets
+	float AngleStep;
+
+	// Angle of each bucket in degrees
+	TArray<float> Angles;
+
+	// 1 if damage has been done through this angle on the previous wave, 0 otherwise. Kept as float so the pheromone kernel can add it directly
+	TArray<float> Damaged;
+
+	// Pheromone quantity of each angle ( Used in ACO )
+	TArray<float> Pheromones;
+
+	// Times succesfully hit through each angle
+	TArray<float> Hits;
+
+	// Best local angles to transmit information between waves ( Used in PSO )
+	TArray<float> LocalBestAngles;
+
+	FSwarmAngleTable()
+		: NumAngles(0)
+		, AngleStep(0.0f)
+	{
+	}
+
+	// Spreads NumAngles buckets evenly around the player and clears all learned data
+	void Initialize(int32 InNumAngles);
+
+	// Bucket closest to the given angle
+	FORCEINLINE int32 GetAngleIndex(float Angle) const
+	{
+		int32 Index = FMath::RoundToInt(Angle / AngleStep) % NumAngles;
+		return Index < 0 ? Index + NumAngles : Index;
+	}
+
+	// First bucket strictly above the given angle, wrapping around to 0 past the last one
+	FORCEINLINE int32 GetNextAngleIndex(float Angle) const
+	{
+		int32 Index = FMath::FloorToInt(Angle / AngleStep) + 1;
+		return Index >= NumAngles ? 0 : FMath::Max(Index, 0);
+	}
+};
+
+// Vectorized kernels over the angle table and the bot columns
+struct FSwarmKernels
+{
+	// Pheromones = Pheromones * (1 - EvaporationRate) + Damaged, returns the new total
+	static float EvaporateAndDeposit(float* RESTRICT Pheromones, const float* RESTRICT Damaged, int32 Num, float EvaporationRate);
+
+	// OutAngles = ConstantWeight * Angles + LocalWeight * RandomLocal * BestLocal + GlobalWeight * RandomGlobal * BestGlobalAngle
+	static void ParticleSwarmStep(float* RESTRICT OutAngles, const float* RESTRICT Angles, const float* RESTRICT BestLocal,
+		const float* RESTRICT RandomLocal, const float* RESTRICT RandomGlobal, int32 Num,
+		float ConstantWeight, float LocalWeight, float GlobalWeight, float BestGlobalAngle);
+};
@@ -0,0 +1,232 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SwarmBenchmark.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/Paths.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/AutomationTest.h"
+
+// Shortest distance in degrees between two angles
+static float GetAngleDistance(float AngleA, float AngleB)
+{
+	const float Distance = FMath::Fmod(FMath::Abs(AngleA - AngleB), 360.0f);
+	return Distance > 180.0f ? 360.0f - Distance : Distance;
+}
+
+// Mean and population variance of the values
+static void GetMeanAndVariance(const TArray<float>& Values, float& OutMean, float& OutVariance)
+{
+	OutMean = 0.0f;
+	OutVariance = 0.0f;
+	if (Values.Num() == 0)
+	{
+		return;
+	}
+
+	for (float Value : Values)
+	{
+		OutMean += Value;
+	}
+	OutMean /= Values.Num();
+
+	for (float Value : Values)
+	{
+		OutVariance += FMath::Square(Value - OutMean);
+	}
+	OutVariance /= Values.Num();
+}
+
+
+FSwarmBenchmark::FSwarmBenchmark()
+{
+	NumWaves = 200;
+	BotsPerWave = 20;
+	NumAngles = 20;
+	NumSeeds = 16;
+	FirstSeed = 1;
+	ConvergenceThreshold = 0.8f;
+	ConvergenceWindow = 5;
+	FinalWavesFraction = 0.1f;
+}
+
+
+TArray<FSwarmScenario> FSwarmBenchmark::GetDefaultScenarios()
+{
+	TArray<FSwarmScenario> Scenarios;
+
+	// Stands still looking at 0 degrees and shoots whatever comes within 60 degrees of it
+	Scenarios.Add(FSwarmScenario(TEXT("StationaryFacing"), [](float AttackAngle, int32 Wave)
+	{
+		return GetAngleDistance(AttackAngle, 0.0f) > 60.0f ? SWARM_HIT_CHANCE : SWARM_MISS_CHANCE;
+	}));
+
+	// Same front arc, turning 5 degrees further every wave
+	Scenarios.Add(FSwarmScenario(TEXT("Rotating"), [](float AttackAngle, int32 Wave)
+	{
+		return GetAngleDistance(AttackAngle, FMath::Fmod(Wave * 5.0f, 360.0f)) > 60.0f ? SWARM_HIT_CHANCE : SWARM_MISS_CHANCE;
+	}));
+
+	// Strafes left for 10 waves then right for 10, only the flank it moves away from is open
+	Scenarios.Add(FSwarmScenario(TEXT("Strafing"), [](float AttackAngle, int32 Wave)
+	{
+		const float OpenFlank = ((Wave / 10) % 2) == 0 ? 90.0f : 270.0f;
+		return GetAngleDistance(AttackAngle, OpenFlank) <= 45.0f ? SWARM_HIT_CHANCE : SWARM_MISS_CHANCE;
+	}));
+
+	Scenarios.Add(FSwarmScenario(TEXT("WeakFlank"), &FSwarmSimulator::WeakFlankHitModel));
+
+	return Scenarios;
+}
+
+
+TArray<FSwarmBenchmarkResult> FSwarmBenchmark::Run(const TArray<ESwarmStrategy>& Strategies, const TArray<FSwarmScenario>& Scenarios) const
+{
+	TArray<FSwarmBenchmarkResult> Results;
+
+	const int32 NumFinalWaves = FMath::Max(1, FMath::CeilToInt(NumWaves * FinalWavesFraction));
+
+	for (ESwarmStrategy Strategy : Strategies)
+	{
+		for (const FSwarmScenario& Scenario : Scenarios)
+		{
+			FSwarmBenchmarkResult& Result = Results[Results.AddDefaulted()];
+			Result.Strategy = Strategy;
+			Result.Scenario = Scenario.Name;
+			Result.NumSeeds = NumSeeds;
+
+			FSwarmSimulator Simulator(Strategy, NumAngles, BotsPerWave);
+			Simulator.SetHitModel(Scenario.HitModel);
+
+			TArray<float> WavesToConvergence;
+			TArray<float> FinalHitRates;
+			const double StartTime = FPlatformTime::Seconds();
+
+			for (int32 SeedIndex = 0; SeedIndex < NumSeeds; SeedIndex++)
+			{
+				FSwarmSimulationResult Run = Simulator.Run(NumWaves, FirstSeed + SeedIndex);
+
+				const int32 Waves = GetWavesToConvergence(Run.DamagingFractionPerWave, ConvergenceThreshold, ConvergenceWindow);
+				if (Waves != INDEX_NONE)
+				{
+					Result.NumConverged++;
+				}
+				WavesToConvergence.Add(Waves != INDEX_NONE ? (float)Waves : (float)NumWaves);
+
+				float FinalHitRate = 0.0f;
+				for (int32 Wave = Run.HitRatePerWave.Num() - NumFinalWaves; Wave < Run.HitRatePerWave.Num(); Wave++)
+				{
+					FinalHitRate += Run.HitRatePerWave[Wave];
+				}
+				FinalHitRates.Add(FinalHitRate / NumFinalWaves);
+			}
+
+			Result.Seconds = FPlatformTime::Seconds() - StartTime;
+			GetMeanAndVariance(WavesToConvergence, Result.MeanWavesToConvergence, Result.VarianceWavesToConvergence);
+			GetMeanAndVariance(FinalHitRates, Result.MeanFinalHitRate, Result.VarianceFinalHitRate);
+		}
+	}
+
+	return Results;
+}
+
+
+FString FSwarmBenchmark::ToJson(const TArray<FSwarmBenchmarkResult>& Results) const
+{
+	FString Json = FString::Printf(TEXT("{\n\t\"Waves\": %d,\n\t\"BotsPerWave\": %d,\n\t\"Angles\": %d,\n\t\"Seeds\": %d,\n\t\"FirstSeed\": %d,\n")
+		TEXT("\t\"EvaporationRate\": %.3f,\n\t\"ConvergenceThreshold\": %.3f,\n\t\"ConvergenceWindow\": %d,\n\t\"Results\": ["),
+		NumWaves, BotsPerWave, NumAngles, NumSeeds, FirstSeed, EVAPORATION_RATE, ConvergenceThreshold, ConvergenceWindow);
+
+	for (int32 ResultIndex = 0; ResultIndex < Results.Num(); ResultIndex++)
+	{
+		const FSwarmBenchmarkResult& Result = Results[ResultIndex];
+		Json += FString::Printf(TEXT("%s\n\t\t{ \"Strategy\": \"%s\", \"Scenario\": \"%s\", \"Converged\": %d, ")
+			TEXT("\"WavesToConvergence\": %.2f, \"WavesToConvergenceVariance\": %.3f, \"FinalHitRate\": %.4f, \"FinalHitRateVariance\": %.6f, \"Seconds\": %.3f }"),
+			ResultIndex > 0 ? TEXT(",") : TEXT(""), GetSwarmStrategyName(Result.Strategy), *Result.Scenario, Result.NumConverged,
+			Result.MeanWavesToConvergence, Result.VarianceWavesToConvergence, Result.MeanFinalHitRate, Result.VarianceFinalHitRate, Result.Seconds);
+	}
+
+	Json += TEXT("\n\t]\n}\n");
+	return Json;
+}
+
+
+int32 FSwarmBenchmark::GetWavesToConvergence(const TArray<float>& DamagingFractionPerWave, float Threshold, int32 Window)
+{
+	int32 WavesInARow = 0;
+	for (int32 Wave = 0; Wave < DamagingFractionPerWave.Num(); Wave++)
+	{
+		WavesInARow = DamagingFractionPerWave[Wave] >= Threshold ? WavesInARow + 1 : 0;
+		if (WavesInARow >= Window)
+		{
+			return Wave - Window + 1;
+		}
+	}
+	return INDEX_NONE;
+}
+
+
+// Runs the benchmark over SDS, ACO and PSO and writes Saved/Reports/SwarmConvergence-<date>.json, returns the file's name
+static FString WriteSwarmBenchmarkReport(const FSwarmBenchmark& Benchmark, TArray<FSwarmBenchmarkResult>& OutResults)
+{
+	TArray<ESwarmStrategy> Strategies;
+	Strategies.Add(ESwarmStrategy::StochasticDiffusion);
+	Strategies.Add(ESwarmStrategy::AntColony);
+	Strategies.Add(ESwarmStrategy::ParticleSwarm);
+
+	OutResults = Benchmark.Run(Strategies, FSwarmBenchmark::GetDefaultScenarios());
+
+	const FString FileName = FPaths::ProjectSavedDir() / TEXT("Reports") / FString::Printf(TEXT("SwarmConvergence-%s.json"), *FDateTime::Now().ToString());
+	FFileHelper::SaveStringToFile(Benchmark.ToJson(OutResults), *FileName);
+
+	for (const FSwarmBenchmarkResult& Result : OutResults)
+	{
+		UE_LOG(LogTemp, Log, TEXT("BenchmarkSwarm %s %s: converged %d/%d, %.1f waves (variance %.1f), final hit rate %.3f (variance %.5f)"),
+			GetSwarmStrategyName(Result.Strategy), *Result.Scenario, Result.NumConverged, Result.NumSeeds,
+			Result.MeanWavesToConvergence, Result.VarianceWavesToConvergence, Result.MeanFinalHitRate, Result.VarianceFinalHitRate);
+	}
+
+	return FileName;
+}
+
+
+static void BenchmarkSwarm(const TArray<FString>& Args)
+{
+	FSwarmBenchmark Benchmark;
+	Benchmark.NumWaves = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : Benchmark.NumWaves;
+	Benchmark.NumSeeds = Args.Num() > 1 ? FMath::Max(FCString::Atoi(*Args[1]), 1) : Benchmark.NumSeeds;
+	Benchmark.BotsPerWave = Args.Num() > 2 ? FMath::Max(FCString::Atoi(*Args[2]), 1) : Benchmark.BotsPerWave;
+
+	TArray<FSwarmBenchmarkResult> Results;
+	const FString FileName = WriteSwarmBenchmarkReport(Benchmark, Results);
+
+	UE_LOG(LogTemp, Log, TEXT("BenchmarkSwarm report written to %s"), *FileName);
+}
+
+FAutoConsoleCommand CCmdBenchmarkSwarm(
+	TEXT("COOP.BenchmarkSwarm"),
+	TEXT("Measures how fast SDS, ACO and PSO converge against scripted players and writes a JSON report. Args: [Waves] [Seeds] [BotsPerWave]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkSwarm));
+
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSwarmConvergenceBenchmarkTest, "CooperativeAI.Benchmark.SwarmConvergence",
+	EAutomationTestFlags::ClientContext | EAutomationTestFlags::ServerContext | EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+bool FSwarmConvergenceBenchmarkTest::RunTest(const FString& Parameters)
+{
+	FSwarmBenchmark Benchmark;
+
+	TArray<FSwarmBenchmarkResult> Results;
+	const FString FileName = WriteSwarmBenchmarkReport(Benchmark, Results);
+	AddInfo(FString::Printf(TEXT("Report written to %s"), *FileName));
+
+	// A benchmark, not a quality bar: the numbers are judged from the report, the test only checks every run happened
+	TestEqual(TEXT("One result per strategy and scenario"), Results.Num(), 3 * FSwarmBenchmark::GetDefaultScenarios().Num());
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
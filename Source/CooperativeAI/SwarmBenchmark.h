@@ -0,0 +1,98 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SwarmSimulator.h"
+
+// Scripted player behavior the strategies learn against
+struct FSwarmScenario
+{
+	FString Name;
+
+	FSwarmHitModel HitModel;
+
+	FSwarmScenario()
+	{
+	}
+
+	FSwarmScenario(const FString& InName, const FSwarmHitModel& InHitModel)
+		: Name(InName)
+		, HitModel(InHitModel)
+	{
+	}
+};
+
+// How one strategy learned one scenario, over every seed
+struct FSwarmBenchmarkResult
+{
+	ESwarmStrategy Strategy;
+
+	FString Scenario;
+
+	int32 NumSeeds;
+
+	// Seeds whose run converged before the last wave
+	int32 NumConverged;
+
+	// Waves until the swarm settled on the damaging angles, the number of waves for runs that never did
+	float MeanWavesToConvergence;
+	float VarianceWavesToConvergence;
+
+	// Hit rate over the last waves of the run
+	float MeanFinalHitRate;
+	float VarianceFinalHitRate;
+
+	double Seconds;
+
+	FSwarmBenchmarkResult()
+		: Strategy(ESwarmStrategy::None)
+		, NumSeeds(0)
+		, NumConverged(0)
+		, MeanWavesToConvergence(0.0f)
+		, VarianceWavesToConvergence(0.0f)
+		, MeanFinalHitRate(0.0f)
+		, VarianceFinalHitRate(0.0f)
+		, Seconds(0.0)
+	{
+	}
+};
+
+/**
+ * Runs every strategy against every scenario with several seeds on FSwarmSimulator and measures how fast and how well it learns.
+ * A run has converged once ConvergenceThreshold of the bots went through damaging angles for ConvergenceWindow waves in a row.
+ */
+class FSwarmBenchmark
+{
+public:
+
+	FSwarmBenchmark();
+
+	// Stationary facing, rotating, strafing and weak flank players
+	static TArray<FSwarmScenario> GetDefaultScenarios();
+
+	TArray<FSwarmBenchmarkResult> Run(const TArray<ESwarmStrategy>& Strategies, const TArray<FSwarmScenario>& Scenarios) const;
+
+	// The settings and results as a JSON document
+	FString ToJson(const TArray<FSwarmBenchmarkResult>& Results) const;
+
+	// First wave of the first ConvergenceWindow waves in a row at or above the threshold, INDEX_NONE if there is none
+	static int32 GetWavesToConvergence(const TArray<float>& DamagingFractionPerWave, float Threshold, int32 Window);
+
+	int32 NumWaves;
+
+	int32 BotsPerWave;
+
+	int32 NumAngles;
+
+	int32 NumSeeds;
+
+	int32 FirstSeed;
+
+	float ConvergenceThreshold;
+
+	int32 ConvergenceWindow;
+
+	// Fraction of the last waves the final hit rate is measured over
+	float FinalWavesFraction;
+};
@@ -0,0 +1,155 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SwarmOptimizer.h"
+#include "SwarmStrategies.h"
+
+
+ESwarmStrategy ParseSwarmStrategy(const FString& Name)
+{
+	if (Name == TEXT("SDS") || Name == TEXT("StochasticDiffusion"))
+	{
+		return ESwarmStrategy::StochasticDiffusion;
+	}
+	if (Name == TEXT("ACO") || Name == TEXT("AntColony"))
+	{
+		return ESwarmStrategy::AntColony;
+	}
+	if (Name == TEXT("PSO") || Name == TEXT("ParticleSwarm"))
+	{
+		return ESwarmStrategy::ParticleSwarm;
+	}
+	return ESwarmStrategy::None;
+}
+
+
+const TCHAR* GetSwarmStrategyName(ESwarmStrategy Strategy)
+{
+	switch (Strategy)
+	{
+	case ESwarmStrategy::StochasticDiffusion:
+		return TEXT("SDS");
+	case ESwarmStrategy::AntColony:
+		return TEXT("ACO");
+	case ESwarmStrategy::ParticleSwarm:
+		return TEXT("PSO");
+	default:
+		return TEXT("None");
+	}
+}
+
+
+FSwarmOptimizer::FSwarmOptimizer()
+{
+	NumAngles = 0;
+	Seed = 0;
+}
+
+
+void FSwarmOptimizer::Initialize(int32 InNumAngles, const TArray<ESwarmStrategy>& Strategies)
+{
+	NumAngles = InNumAngles;
+
+	SubSwarms.Reset();
+	for (ESwarmStrategy Strategy : Strategies)
+	{
+		if (Strategy == ESwarmStrategy::None)
+		{
+			continue;
+		}
+
+		FSwarmSubSwarm& SubSwarm = SubSwarms[SubSwarms.AddDefaulted()];
+		SubSwarm.Strategy = Strategy;
+		SubSwarm.AngleTable.Initialize(NumAngles);
+	}
+
+	SetSeed(Seed);
+}
+
+
+void FSwarmOptimizer::SetSeed(uint64 InSeed)
+{
+	Seed = InSeed;
+
+	for (int32 SubSwarmIndex = 0; SubSwarmIndex < SubSwarms.Num(); SubSwarmIndex++)
+	{
+		FSwarmSubSwarm& SubSwarm = SubSwarms[SubSwarmIndex];
+		SubSwarm.WaveCounter = 0;
+		SubSwarm.StrategyStream.Initialize(Seed, FSwarmRandom::MakeStream(SubSwarmIndex, (uint64)SubSwarm.Strategy, MAX_uint32));
+	}
+}
+
+
+void FSwarmOptimizer::RecordHit(int32 SubSwarmIndex, float AttackAngle)
+{
+	if (!SubSwarms.IsValidIndex(SubSwarmIndex))
+	{
+		return;
+	}
+
+	FSwarmSubSwarm& SubSwarm = SubSwarms[SubSwarmIndex];
+	int32 AngleIndex = SubSwarm.AngleTable.GetAngleIndex(AttackAngle);
+	SubSwarm.AngleTable.Damaged[AngleIndex] = 1.0f;
+	SubSwarm.AngleTable.Hits[AngleIndex] += 1.0f;
+
+	SubSwarm.WaveHits++;
+	SubSwarm.TotalHits++;
+}
+
+
+void FSwarmOptimizer::RecordMiss(int32 SubSwarmIndex, float AttackAngle)
+{
+	if (!SubSwarms.IsValidIndex(SubSwarmIndex))
+	{
+		return;
+	}
+
+	FSwarmSubSwarm& SubSwarm = SubSwarms[SubSwarmIndex];
+	SubSwarm.AngleTable.Damaged[SubSwarm.AngleTable.GetAngleIndex(AttackAngle)] = 0.0f;
+
+	SubSwarm.WaveMisses++;
+	SubSwarm.TotalMisses++;
+}
+
+
+void FSwarmOptimizer::Update(int32 SubSwarmIndex, FSwarmBotBatch& Bots)
+{
+	if (!SubSwarms.IsValidIndex(SubSwarmIndex))
+	{
+		return;
+	}
+
+	FSwarmSubSwarm& SubSwarm = SubSwarms[SubSwarmIndex];
+	PrepareBotStreams(SubSwarm, SubSwarmIndex, Bots.Num());
+
+	// The only strategy dispatch, once per sub-swarm
+	switch (SubSwarm.Strategy)
+	{
+	case ESwarmStrategy::StochasticDiffusion:
+		TSwarmStrategy<FStochasticDiffusionPolicy>::Update(SubSwarm, Bots);
+		break;
+	case ESwarmStrategy::AntColony:
+		TSwarmStrategy<FAntColonyPolicy>::Update(SubSwarm, Bots);
+		break;
+	case ESwarmStrategy::ParticleSwarm:
+		TSwarmStrategy<FParticleSwarmPolicy>::Update(SubSwarm, Bots);
+		break;
+	default:
+		break;
+	}
+
+	SubSwarm.WaveCounter++;
+	SubSwarm.WaveHits = 0;
+	SubSwarm.WaveMisses = 0;
+}
+
+
+void FSwarmOptimizer::PrepareBotStreams(FSwarmSubSwarm& SubSwarm, int32 SubSwarmIndex, int32 NumBots)
+{
+	const uint64 SubSwarmStream = FSwarmRandom::MakeStream(SubSwarmIndex, (uint64)SubSwarm.Strategy, SubSwarm.WaveCounter);
+
+	SubSwarm.BotStreams.SetNum(NumBots);
+	ParallelForBots(NumBots, [&SubSwarm, SubSwarmStream, this](int32 BotIndex)
+	{
+		SubSwarm.BotStreams[BotIndex].Initialize(Seed, SubSwarmStream + BotIndex);
+	});
+}
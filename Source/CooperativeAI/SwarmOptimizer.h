@@ -0,0 +1,157 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SwarmAngleTable.h"
+#include "SwarmAliasTable.h"
+#include "SwarmRandom.h"
+#define EVAPORATION_RATE 0.25f
+
+// Learning strategy used to pick the attack angles of the bots between waves
+enum class ESwarmStrategy : uint8
+{
+	None,
+
+	StochasticDiffusion,
+
+	AntColony,
+
+	ParticleSwarm,
+};
+
+// Accepts SDS, ACO and PSO as well as the full strategy names
+ESwarmStrategy ParseSwarmStrategy(const FString& Name);
+
+// Short name used in logs and reports
+const TCHAR* GetSwarmStrategyName(ESwarmStrategy Strategy);
+
+// Swarm view of a batch of bots as parallel columns, the strategies only read and write these values
+struct FSwarmBotBatch
+{
+	// Angle in degrees from which each bot will try to approach the players, 0 means no hypothesis yet
+	TArray<float> AttackAngles;
+
+	// Best angle observed by each bot ( Used in PSO )
+	TArray<float> BestLocalAngles;
+
+	int32 Num() const { return AttackAngles.Num(); }
+
+	void Reset(int32 NewSize = 0)
+	{
+		AttackAngles.Reset(NewSize);
+		BestLocalAngles.Reset(NewSize);
+	}
+
+	void Add(float AttackAngle, float BestLocalAngle)
+	{
+		AttackAngles.Add(AttackAngle);
+		BestLocalAngles.Add(BestLocalAngle);
+	}
+
+	// Appends bots without any hypothesis
+	void AddNew(int32 Count)
+	{
+		AttackAngles.AddZeroed(Count);
+		BestLocalAngles.AddZeroed(Count);
+	}
+};
+
+/**
+ * A group of bots learning with one strategy.
+ * Each sub-swarm keeps its own angle table so several strategies can run side by side in one match without sharing what they learned.
+ */
+struct FSwarmSubSwarm
+{
+	ESwarmStrategy Strategy;
+
+	FSwarmAngleTable AngleTable;
+
+	// Stores the current best angle for the swarm in PSO mode
+	float BestGlobalAngle;
+
+	// Number of updates run so far, mixed into the bot streams so every wave draws fresh numbers
+	uint32 WaveCounter;
+
+	// Stream of the draws made once per wave rather than once per bot
+	FSwarmRandom StrategyStream;
+
+	// Stream of each bot for the current wave
+	TArray<FSwarmRandom> BotStreams;
+
+	// Outcomes recorded since the last update, and since the start of the match
+	int32 WaveHits;
+	int32 WaveMisses;
+	int32 TotalHits;
+	int32 TotalMisses;
+
+	// Pheromone roulette wheel of the current wave ( Used in ACO )
+	FSwarmAliasTable SelectionTable;
+
+	// Scratch columns reused between waves so EndWave does not allocate ( Used in PSO )
+	TArray<float> RandomLocal;
+	TArray<float> RandomGlobal;
+	TArray<float> NewAngles;
+	TArray<uint8> Improved;
+
+	FSwarmSubSwarm()
+		: Strategy(ESwarmStrategy::None)
+		, BestGlobalAngle(0.0f)
+		, WaveCounter(0)
+		, WaveHits(0)
+		, WaveMisses(0)
+		, TotalHits(0)
+		, TotalMisses(0)
+	{
+	}
+
+	float GetWaveHitRate() const { return (WaveHits + WaveMisses) > 0 ? (float)WaveHits / (WaveHits + WaveMisses) : 0.0f; }
+
+	float GetTotalHitRate() const { return (TotalHits + TotalMisses) > 0 ? (float)TotalHits / (TotalHits + TotalMisses) : 0.0f; }
+};
+
+/**
+ * Engine independent core of the swarm learning.
+ * Holds one sub-swarm per strategy in play and runs SDS, ACO or PSO over the bots of each of them.
+ * Knows nothing about UWorld or actors so it can be driven by the game mode as well as by FSwarmSimulator.
+ */
+class FSwarmOptimizer
+{
+public:
+
+	FSwarmOptimizer();
+
+	// Resets all learned data, creates one sub-swarm per strategy and spreads NumAngles attack angles evenly around the player
+	void Initialize(int32 InNumAngles, const TArray<ESwarmStrategy>& Strategies);
+
+	// Reseeds every strategy and bot stream, the same seed reproduces the same angles for the same outcomes
+	void SetSeed(uint64 InSeed);
+
+	uint64 GetSeed() const { return Seed; }
+
+	// A bot of the sub-swarm approaching through AttackAngle reached and damaged a player
+	void RecordHit(int32 SubSwarmIndex, float AttackAngle);
+
+	// A bot of the sub-swarm approaching through AttackAngle was destroyed before damaging anyone
+	void RecordMiss(int32 SubSwarmIndex, float AttackAngle);
+
+	// Runs one wave-end step of the sub-swarm's strategy over its bots
+	void Update(int32 SubSwarmIndex, FSwarmBotBatch& Bots);
+
+	int32 GetNumSubSwarms() const { return SubSwarms.Num(); }
+
+	const FSwarmSubSwarm& GetSubSwarm(int32 SubSwarmIndex) const { return SubSwarms[SubSwarmIndex]; }
+
+	int32 GetNumAngles() const { return NumAngles; }
+
+protected:
+
+	// Derives this wave's stream of every bot of the sub-swarm
+	void PrepareBotStreams(FSwarmSubSwarm& SubSwarm, int32 SubSwarmIndex, int32 NumBots);
+
+	TArray<FSwarmSubSwarm> SubSwarms;
+
+	int32 NumAngles;
+
+	uint64 Seed;
+};
@@ -0,0 +1,106 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Small xoshiro128** generator for the swarm.
+ * Every stream is derived from a seed and a stream id through SplitMix64, so each strategy and each bot can own an
+ * independent, reproducible sequence that is safe to draw from on any thread.
+ */
+struct FSwarmRandom
+{
+	FSwarmRandom(uint64 Seed = 0, uint64 Stream = 0)
+	{
+		Initialize(Seed, Stream);
+	}
+
+	void Initialize(uint64 Seed, uint64 Stream)
+	{
+		uint64 Mix = Seed ^ (Stream * 0xD1B54A32D192ED03ull);
+		uint64 A = SplitMix64(Mix);
+		uint64 B = SplitMix64(Mix);
+
+		State[0] = (uint32)A;
+		State[1] = (uint32)(A >> 32);
+		State[2] = (uint32)B;
+		State[3] = (uint32)(B >> 32);
+
+		// An all zero state would only ever produce zeros
+		if ((State[0] | State[1] | State[2] | State[3]) == 0)
+		{
+			State[0] = 1;
+		}
+	}
+
+	FORCEINLINE uint32 Next()
+	{
+		const uint32 Result = Rotl(State[1] * 5, 7) * 9;
+		const uint32 Shifted = State[1] << 9;
+
+		State[2] ^= State[0];
+		State[3] ^= State[1];
+		State[1] ^= State[2];
+		State[0] ^= State[3];
+		State[2] ^= Shifted;
+		State[3] = Rotl(State[3], 11);
+
+		return Result;
+	}
+
+	// Uniform float in [0, 1)
+	FORCEINLINE float FRand()
+	{
+		return (Next() >> 8) * (1.0f / 16777216.0f);
+	}
+
+	// Uniform integer in [0, Max) without modulo bias, 0 if Max is not positive
+	FORCEINLINE int32 RandHelper(int32 Max)
+	{
+		if (Max <= 0)
+		{
+			return 0;
+		}
+
+		const uint32 Range = (uint32)Max;
+		uint64 Product = (uint64)Next() * Range;
+		uint32 Low = (uint32)Product;
+		if (Low < Range)
+		{
+			const uint32 Threshold = (0u - Range) % Range;
+			while (Low < Threshold)
+			{
+				Product = (uint64)Next() * Range;
+				Low = (uint32)Product;
+			}
+		}
+		return (int32)(Product >> 32);
+	}
+
+	// Packs up to three small keys (strategy, wave, bot...) into a stream id
+	static FORCEINLINE uint64 MakeStream(uint64 A, uint64 B, uint64 C = 0)
+	{
+		uint64 Mix = A;
+		Mix = SplitMix64(Mix) ^ B;
+		Mix = SplitMix64(Mix) ^ C;
+		return SplitMix64(Mix);
+	}
+
+	static FORCEINLINE uint64 SplitMix64(uint64& InOutState)
+	{
+		uint64 Z = (InOutState += 0x9E3779B97F4A7C15ull);
+		Z = (Z ^ (Z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		Z = (Z ^ (Z >> 27)) * 0x94D049BB133111EBull;
+		return Z ^ (Z >> 31);
+	}
+
+protected:
+
+	static FORCEINLINE uint32 Rotl(uint32 Value, int32 Shift)
+	{
+		return (Value << Shift) | (Value >> (32 - Shift));
+	}
+
+	uint32 State[4];
+};
@@ -0,0 +1,108 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SwarmSimulator.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+
+
+FSwarmSimulator::FSwarmSimulator(ESwarmStrategy InStrategy, int32 InNumAngles, int32 InBotsPerWave)
+{
+	Strategy = InStrategy;
+	NumAngles = InNumAngles;
+	BotsPerWave = InBotsPerWave;
+
+	HitModel = &FSwarmSimulator::WeakFlankHitModel;
+}
+
+
+FSwarmSimulationResult FSwarmSimulator::Run(int32 NumWaves, int32 Seed)
+{
+	FSwarmSimulationResult Result;
+
+	FSwarmRandom HitStream(Seed, FSwarmRandom::MakeStream(MAX_uint32, MAX_uint32));
+	TArray<ESwarmStrategy> Strategies;
+	Strategies.Add(Strategy);
+
+	Optimizer.Initialize(NumAngles, Strategies);
+	Optimizer.SetSeed(Seed);
+
+	FSwarmBotBatch Bots;
+
+	double StartTime = FPlatformTime::Seconds();
+
+	for (int32 Wave = 0; Wave < NumWaves; Wave++)
+	{
+		// Freshly spawned bots have no hypothesis yet
+		Bots.Reset(BotsPerWave);
+		Bots.AddNew(BotsPerWave);
+
+		// All bots of the wave are spawned when EndWave runs the strategy
+		Optimizer.Update(0, Bots);
+
+		int32 WaveHits = 0;
+		int32 WaveDamaging = 0;
+		for (float AttackAngle : Bots.AttackAngles)
+		{
+			const float HitChance = HitModel(AttackAngle, Wave);
+			if (HitChance > 0.5f)
+			{
+				WaveDamaging++;
+			}
+
+			if (HitStream.FRand() < HitChance)
+			{
+				Optimizer.RecordHit(0, AttackAngle);
+				WaveHits++;
+			}
+			else
+			{
+				Optimizer.RecordMiss(0, AttackAngle);
+			}
+		}
+
+		Result.Hits += WaveHits;
+		Result.BotsSimulated += Bots.Num();
+		Result.HitRatePerWave.Add(Bots.Num() > 0 ? (float)WaveHits / Bots.Num() : 0.0f);
+		Result.DamagingFractionPerWave.Add(Bots.Num() > 0 ? (float)WaveDamaging / Bots.Num() : 0.0f);
+	}
+
+	Result.Waves = NumWaves;
+	Result.Seconds = FPlatformTime::Seconds() - StartTime;
+
+	return Result;
+}
+
+
+float FSwarmSimulator::WeakFlankHitModel(float AttackAngle, int32 Wave)
+{
+	return (AttackAngle >= 135.0f && AttackAngle <= 225.0f) ? SWARM_HIT_CHANCE : SWARM_MISS_CHANCE;
+}
+
+
+static void SimulateSwarm(const TArray<FString>& Args)
+{
+	if (Args.Num() < 1)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Usage: COOP.SimulateSwarm <SDS|ACO|PSO> [Waves] [BotsPerWave] [Seed] [Angles]"));
+		return;
+	}
+
+	ESwarmStrategy Strategy = ParseSwarmStrategy(Args[0]);
+	int32 Waves = Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 1000;
+	int32 BotsPerWave = Args.Num() > 2 ? FCString::Atoi(*Args[2]) : 20;
+	int32 Seed = Args.Num() > 3 ? FCString::Atoi(*Args[3]) : 0;
+	int32 NumAngles = Args.Num() > 4 ? FCString::Atoi(*Args[4]) : 20;
+
+	FSwarmSimulator Simulator(Strategy, FMath::Max(NumAngles, 3), BotsPerWave);
+	FSwarmSimulationResult Result = Simulator.Run(Waves, Seed);
+
+	UE_LOG(LogTemp, Log, TEXT("SimulateSwarm %s: %d waves, %d bots, hit rate %.3f, last wave %.3f, %.1f waves/s"),
+		*Args[0], Result.Waves, Result.BotsSimulated, Result.GetHitRate(),
+		Result.HitRatePerWave.Num() > 0 ? Result.HitRatePerWave.Last() : 0.0f,
+		Result.Seconds > 0.0 ? Result.Waves / Result.Seconds : 0.0);
+}
+
+FAutoConsoleCommand CCmdSimulateSwarm(
+	TEXT("COOP.SimulateSwarm"),
+	TEXT("Runs a swarm strategy headless against a scripted hit model. Args: <SDS|ACO|PSO> [Waves] [BotsPerWave] [Seed] [Angles]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&SimulateSwarm));
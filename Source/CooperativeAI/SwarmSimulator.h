@@ -0,0 +1,75 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SwarmOptimizer.h"
+
+// Chance of hitting through a damaging angle and through any other one, used by the weak flank model and the benchmark scenarios
+#define SWARM_HIT_CHANCE 0.9f
+#define SWARM_MISS_CHANCE 0.05f
+
+// Chance of a bot approaching through AttackAngle on the given wave to reach and damage a player
+typedef TFunction<float(float AttackAngle, int32 Wave)> FSwarmHitModel;
+
+// Outcome of a headless simulation run
+struct FSwarmSimulationResult
+{
+	int32 Waves;
+
+	int32 BotsSimulated;
+
+	int32 Hits;
+
+	// Wall clock time spent simulating
+	double Seconds;
+
+	// Fraction of the bots of each wave that damaged a player
+	TArray<float> HitRatePerWave;
+
+	// Fraction of the bots of each wave sent through an angle the hit model made more likely to hit than not
+	TArray<float> DamagingFractionPerWave;
+
+	FSwarmSimulationResult()
+		: Waves(0)
+		, BotsSimulated(0)
+		, Hits(0)
+		, Seconds(0.0)
+	{
+	}
+
+	float GetHitRate() const { return BotsSimulated > 0 ? (float)Hits / BotsSimulated : 0.0f; }
+};
+
+/**
+ * Runs a swarm strategy wave after wave against a scripted hit model instead of a UWorld.
+ * Each wave spawns fresh bots, lets the strategy pick their angles like EndWave does and then resolves every bot as a hit or a miss.
+ */
+class FSwarmSimulator
+{
+public:
+
+	FSwarmSimulator(ESwarmStrategy InStrategy, int32 InNumAngles, int32 InBotsPerWave);
+
+	void SetHitModel(const FSwarmHitModel& InHitModel) { HitModel = InHitModel; }
+
+	// Resets the learned data and simulates NumWaves waves
+	FSwarmSimulationResult Run(int32 NumWaves, int32 Seed);
+
+	const FSwarmOptimizer& GetOptimizer() const { return Optimizer; }
+
+	// Default scripted player: only bots approaching from behind (135 to 225 degrees) get through
+	static float WeakFlankHitModel(float AttackAngle, int32 Wave);
+
+protected:
+
+	FSwarmOptimizer Optimizer;
+
+	FSwarmHitModel HitModel;
+
+	ESwarmStrategy Strategy;
+
+	int32 NumAngles;
+
+	int32 BotsPerWave;
+};
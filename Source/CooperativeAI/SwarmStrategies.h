@@ -0,0 +1,178 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/ParallelFor.h"
+#include "SwarmOptimizer.h"
+
+// Bots handled by one worker task, smaller updates run on the calling thread
+#define SWARM_PARALLEL_BATCH 256
+
+// Runs Body(BotIndex) for every bot, in batches spread over the worker threads
+template <typename TBody>
+void ParallelForBots(int32 NumBots, const TBody& Body)
+{
+	const int32 NumBatches = FMath::DivideAndRoundUp(NumBots, SWARM_PARALLEL_BATCH);
+
+	ParallelFor(NumBatches, [&Body, NumBots](int32 Batch)
+	{
+		const int32 FirstBot = Batch * SWARM_PARALLEL_BATCH;
+		const int32 LastBot = FMath::Min(FirstBot + SWARM_PARALLEL_BATCH, NumBots);
+		for (int32 BotIndex = FirstBot; BotIndex < LastBot; BotIndex++)
+		{
+			Body(BotIndex);
+		}
+	}, NumBatches <= 1);
+}
+
+/**
+ * Compile time strategy policies.
+ * TSwarmStrategy<Policy> runs BeginWave once, UpdateBot for every bot and EndWave once, so the per bot step is
+ * inlined into the loop and the strategy is only picked once per sub-swarm, never per bot.
+ * UpdateBot runs on worker threads: it must only write the entries of its own bot, anything shared by the sub-swarm is written in BeginWave or EndWave.
+ */
+template <typename TPolicy>
+struct TSwarmStrategy
+{
+	static void Update(FSwarmSubSwarm& SubSwarm, FSwarmBotBatch& Bots)
+	{
+		TPolicy::BeginWave(SubSwarm, Bots);
+
+		ParallelForBots(Bots.Num(), [&SubSwarm, &Bots](int32 BotIndex)
+		{
+			TPolicy::UpdateBot(SubSwarm, Bots, BotIndex, SubSwarm.BotStreams[BotIndex]);
+		});
+
+		TPolicy::EndWave(SubSwarm, Bots);
+	}
+};
+
+// Shared by every strategy: gives a random hypothesis to the bots that have none yet
+FORCEINLINE void AssignInitialAngle(const FSwarmAngleTable& AngleTable, FSwarmBotBatch& Bots, int32 BotIndex, FSwarmRandom& Random)
+{
+	if (Bots.AttackAngles[BotIndex] == 0.0f) {
+		Bots.AttackAngles[BotIndex] = AngleTable.Angles[Random.RandHelper(AngleTable.NumAngles)];
+	}
+}
+
+// Diffusion phase, the non damaging bots seek new hypothesis for themselves
+struct FStochasticDiffusionPolicy
+{
+	static void BeginWave(FSwarmSubSwarm& SubSwarm, FSwarmBotBatch& Bots)
+	{
+	}
+
+	static FORCEINLINE void UpdateBot(FSwarmSubSwarm& SubSwarm, FSwarmBotBatch& Bots, int32 BotIndex, FSwarmRandom& Random)
+	{
+		const FSwarmAngleTable& AngleTable = SubSwarm.AngleTable;
+
+		//  Set random hypothesis to the newly spawned bots
+		AssignInitialAngle(AngleTable, Bots, BotIndex, Random);
+
+		// Check if hypothesis has damaged players and if not select another at random up to twice
+		if (AngleTable.Damaged[AngleTable.GetAngleIndex(Bots.AttackAngles[BotIndex])] > 0.0f) {
+			return;
+		}
+
+		int32 Candidate = Random.RandHelper(AngleTable.NumAngles);
+		if (AngleTable.Damaged[Candidate] <= 0.0f) {
+			Candidate = Random.RandHelper(AngleTable.NumAngles);
+		}
+		Bots.AttackAngles[BotIndex] = AngleTable.Angles[Candidate];
+	}
+
+	static void EndWave(FSwarmSubSwarm& SubSwarm, FSwarmBotBatch& Bots)
+	{
+	}
+};
+
+// Ant selection of solution and deposit/evaporation of pheromones
+struct FAntColonyPolicy
+{
+	static void BeginWave(FSwarmSubSwarm& SubSwarm, FSwarmBotBatch& Bots)
+	{
+		FSwarmAngleTable& AngleTable = SubSwarm.AngleTable;
+
+		// Evaporation and deposit of pheromones
+		FSwarmKernels::EvaporateAndDeposit(AngleTable.Pheromones.GetData(), AngleTable.Damaged.GetData(), AngleTable.NumAngles, EVAPORATION_RATE);
+
+		// Selection, roulette wheel over the pheromones built once for the whole wave
+		SubSwarm.SelectionTable.Build(AngleTable.Pheromones.GetData(), AngleTable.NumAngles);
+	}
+
+	static FORCEINLINE void UpdateBot(FSwarmSubSwarm& SubSwarm, FSwarmBotBatch& Bots, int32 BotIndex, FSwarmRandom& Random)
+	{
+		Bots.AttackAngles[BotIndex] = SubSwarm.AngleTable.Angles[SubSwarm.SelectionTable.Sample(Random.FRand())];
+	}
+
+	static void EndWave(FSwarmSubSwarm& SubSwarm, FSwarmBotBatch& Bots)
+	{
+	}
+};
+
+struct FParticleSwarmPolicy
+{
+	// Weights on how much do the actual actor's angle, actor's best known angle and swarm's best known angle affect the next selected angle
+	static constexpr float ConstantWeight = 0.1f;
+	static constexpr float LocalWeight = 0.45f;
+	static constexpr float GlobalWeight = 0.45f;
+
+	static void BeginWave(FSwarmSubSwarm& SubSwarm, FSwarmBotBatch& Bots)
+	{
+		const FSwarmAngleTable& AngleTable = SubSwarm.AngleTable;
+		const int32 NumBots = Bots.Num();
+
+		// Random numbers to continue the solution space search both locally (one actor) and globally (whole swarm)
+		SubSwarm.RandomLocal.SetNumUninitialized(NumBots);
+		SubSwarm.RandomGlobal.SetNumUninitialized(NumBots);
+		ParallelForBots(NumBots, [&SubSwarm, &AngleTable, &Bots](int32 BotIndex)
+		{
+			FSwarmRandom& Random = SubSwarm.BotStreams[BotIndex];
+
+			//  Set random hypothesis to the newly spawned bots (will be changed by the algorithm)
+			AssignInitialAngle(AngleTable, Bots, BotIndex, Random);
+			Bots.BestLocalAngles[BotIndex] = AngleTable.LocalBestAngles[Random.RandHelper(AngleTable.NumAngles)];
+
+			SubSwarm.RandomLocal[BotIndex] = Random.FRand();
+			SubSwarm.RandomGlobal[BotIndex] = Random.FRand();
+		});
+
+		// The new angle each actor will take
+		SubSwarm.NewAngles.SetNumUninitialized(NumBots);
+		FSwarmKernels::ParticleSwarmStep(SubSwarm.NewAngles.GetData(), Bots.AttackAngles.GetData(), Bots.BestLocalAngles.GetData(),
+			SubSwarm.RandomLocal.GetData(), SubSwarm.RandomGlobal.GetData(), NumBots, ConstantWeight, LocalWeight, GlobalWeight, SubSwarm.BestGlobalAngle);
+
+		SubSwarm.Improved.SetNumUninitialized(NumBots);
+	}
+
+	static FORCEINLINE void UpdateBot(FSwarmSubSwarm& SubSwarm, FSwarmBotBatch& Bots, int32 BotIndex, FSwarmRandom& Random)
+	{
+		const FSwarmAngleTable& AngleTable = SubSwarm.AngleTable;
+
+		// Snap to the next possible attack angle
+		int32 NewAngleIndex = AngleTable.GetNextAngleIndex(FMath::Fmod(SubSwarm.NewAngles[BotIndex], 360.0f));
+		Bots.AttackAngles[BotIndex] = AngleTable.Angles[NewAngleIndex];
+
+		// The shared bests are updated in EndWave, in bot order
+		SubSwarm.Improved[BotIndex] = AngleTable.Hits[NewAngleIndex] > AngleTable.Hits[AngleTable.GetAngleIndex(Bots.BestLocalAngles[BotIndex])];
+	}
+
+	static void EndWave(FSwarmSubSwarm& SubSwarm, FSwarmBotBatch& Bots)
+	{
+		FSwarmAngleTable& AngleTable = SubSwarm.AngleTable;
+
+		for (int32 BotIndex = 0; BotIndex < Bots.Num(); BotIndex++)
+		{
+			if (!SubSwarm.Improved[BotIndex]) {
+				continue;
+			}
+
+			AngleTable.LocalBestAngles[SubSwarm.StrategyStream.RandHelper(AngleTable.NumAngles)] = Bots.AttackAngles[BotIndex];
+
+			if (AngleTable.Hits[AngleTable.GetAngleIndex(Bots.BestLocalAngles[BotIndex])] > AngleTable.Hits[AngleTable.GetAngleIndex(SubSwarm.BestGlobalAngle)]) {
+				SubSwarm.BestGlobalAngle = Bots.BestLocalAngles[BotIndex];
+			}
+		}
+	}
+};
@@ -0,0 +1,77 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TeamRegistry.h"
+#include "SHealthComponent.h"
+#include "GameFramework/Actor.h"
+
+
+void FTeamRegistry::Register(USHealthComponent* HealthComp)
+{
+	AActor* Owner = HealthComp->GetOwner();
+	if (Owner == nullptr || ByOwner.Contains(Owner))
+	{
+		return;
+	}
+
+	ByOwner.Add(Owner, HealthComp);
+	Teams.FindOrAdd(HealthComp->TeamNum).Add(HealthComp);
+}
+
+
+void FTeamRegistry::Unregister(USHealthComponent* HealthComp)
+{
+	AActor* Owner = HealthComp->GetOwner();
+	if (Owner == nullptr || ByOwner.Remove(Owner) == 0)
+	{
+		return;
+	}
+
+	TArray<USHealthComponent*>* Team = Teams.Find(HealthComp->TeamNum);
+	if (Team)
+	{
+		Team->RemoveSingleSwap(HealthComp, false);
+	}
+}
+
+
+void FTeamRegistry::Reset()
+{
+	ByOwner.Reset();
+	Teams.Reset();
+}
+
+
+USHealthComponent* FTeamRegistry::Find(const AActor* Actor) const
+{
+	USHealthComponent* const* HealthComp = ByOwner.Find(Actor);
+	return HealthComp ? *HealthComp : nullptr;
+}
+
+
+const TArray<USHealthComponent*>& FTeamRegistry::GetTeam(uint8 TeamNum) const
+{
+	static const TArray<USHealthComponent*> NoMembers;
+
+	const TArray<USHealthComponent*>* Team = Teams.Find(TeamNum);
+	return Team ? *Team : NoMembers;
+}
+
+
+void FTeamRegistry::GetAliveHostiles(uint8 TeamNum, TArray<USHealthComponent*>& OutHostiles) const
+{
+	for (const TPair<uint8, TArray<USHealthComponent*>>& Team : Teams)
+	{
+		if (Team.Key == TeamNum)
+		{
+			continue;
+		}
+
+		for (USHealthComponent* HealthComp : Team.Value)
+		{
+			if (HealthComp->GetHealth() > 0.0f)
+			{
+				OutHostiles.Add(HealthComp);
+			}
+		}
+	}
+}
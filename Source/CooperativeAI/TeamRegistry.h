@@ -0,0 +1,42 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class AActor;
+class USHealthComponent;
+
+/**
+ * Health component and team of every actor in the world that has one.
+ * Components add themselves on BeginPlay and remove themselves on EndPlay, so friend or foe checks are a map lookup
+ * instead of a component search, and the members of a team can be walked without touching any actor.
+ */
+class FTeamRegistry
+{
+public:
+
+	void Register(USHealthComponent* HealthComp);
+
+	void Unregister(USHealthComponent* HealthComp);
+
+	// Forgets every component, used when the world is torn down
+	void Reset();
+
+	// Health component of Actor, null when it has none or it is not registered
+	USHealthComponent* Find(const AActor* Actor) const;
+
+	// Every registered component of the team, alive or dead
+	const TArray<USHealthComponent*>& GetTeam(uint8 TeamNum) const;
+
+	// Appends the components of every other team that still have health
+	void GetAliveHostiles(uint8 TeamNum, TArray<USHealthComponent*>& OutHostiles) const;
+
+	int32 Num() const { return ByOwner.Num(); }
+
+protected:
+
+	TMap<const AActor*, USHealthComponent*> ByOwner;
+
+	TMap<uint8, TArray<USHealthComponent*>> Teams;
+};
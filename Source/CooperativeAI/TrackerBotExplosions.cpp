@@ -0,0 +1,269 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TrackerBotExplosions.h"
+#include "CooperativeAI.h"
+#include "Engine/World.h"
+#include "Engine/DamageEvents.h"
+#include "Components/PrimitiveComponent.h"
+#include "GameFramework/Actor.h"
+#include "GameFramework/Controller.h"
+#include "GameFramework/DamageType.h"
+
+DECLARE_CYCLE_STAT(TEXT("Bot Explosions"), STAT_BotExplosions, STATGROUP_COOP);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Explosions Resolved"), STAT_ExplosionsResolved, STATGROUP_COOP);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Explosion Queries"), STAT_ExplosionQueries, STATGROUP_COOP);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Explosion Traces"), STAT_ExplosionTraces, STATGROUP_COOP);
+
+// Damage of one victim summed over the frame's explosions
+struct FExplosionVictim
+{
+	// Explosion closest to the victim, it is reported as the origin of the damage
+	int32 NearestExplosion;
+
+	float NearestDistanceSquared;
+
+	float Damage;
+
+	FHitResult Hit;
+
+	// Explosions already counted, an actor is hurt once per explosion whatever its number of components
+	TArray<int32, TInlineAllocator<4>> Explosions;
+
+	FExplosionVictim()
+		: NearestExplosion(INDEX_NONE)
+		, NearestDistanceSquared(FLT_MAX)
+		, Damage(0.0f)
+	{
+	}
+};
+
+
+FTrackerBotExplosions::FTrackerBotExplosions()
+{
+	TraceShareDistance = 50.0f;
+}
+
+
+void FTrackerBotExplosions::QueueExplosion(const FVector& Origin, float Damage, float Radius, AActor* DamageCauser, AController* InstigatedBy)
+{
+	FTrackerBotExplosion Explosion;
+	Explosion.Origin = Origin;
+	Explosion.Damage = Damage;
+	Explosion.Radius = Radius;
+	Explosion.DamageCauser = DamageCauser;
+	Explosion.InstigatedBy = InstigatedBy;
+	Queued.Add(Explosion);
+}
+
+
+void FTrackerBotExplosions::Tick(UWorld* World)
+{
+	if (Queued.Num() == 0 || !World)
+	{
+		return;
+	}
+
+	COOP_SCOPE_CYCLE_COUNTER(STAT_BotExplosions, Explosions);
+
+	// Bots killed by these explosions queue theirs for the next frame
+	Swap(Queued, Resolving);
+	Queued.Reset();
+	Traces.Reset();
+
+	BuildClusters();
+
+	// The exploded bots have no collision left, the query only finds their victims
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(TrackerBotExplosions), false);
+	for (const FTrackerBotExplosion& Explosion : Resolving)
+	{
+		if (Explosion.DamageCauser.IsValid())
+		{
+			QueryParams.AddIgnoredActor(Explosion.DamageCauser.Get());
+		}
+	}
+
+	TMap<AActor*, FExplosionVictim> Victims;
+	TArray<FOverlapResult> Overlaps;
+	for (const FTrackerBotExplosionCluster& Cluster : Clusters)
+	{
+		Overlaps.Reset();
+		World->OverlapMultiByObjectType(Overlaps, Cluster.Center, FQuat::Identity, FCollisionObjectQueryParams(FCollisionObjectQueryParams::InitType::AllDynamicObjects),
+			FCollisionShape::MakeSphere(Cluster.Radius), QueryParams);
+
+		for (const FOverlapResult& Overlap : Overlaps)
+		{
+			AActor* Victim = Overlap.GetActor();
+			UPrimitiveComponent* Component = Overlap.GetComponent();
+			if (!Victim || !Component || !Victim->bCanBeDamaged)
+			{
+				continue;
+			}
+
+			// The overlap covers the cluster, every explosion still only reaches its own radius
+			for (int32 ExplosionIndex : Cluster.Explosions)
+			{
+				const FTrackerBotExplosion& Explosion = Resolving[ExplosionIndex];
+
+				FVector ClosestPoint;
+				float Distance = Component->GetDistanceToCollision(Explosion.Origin, ClosestPoint);
+				if (Distance < 0.0f)
+				{
+					Distance = FMath::Max(0.0f, FVector::Dist(Explosion.Origin, Component->Bounds.Origin) - Component->Bounds.SphereRadius);
+				}
+				if (Distance > Explosion.Radius)
+				{
+					continue;
+				}
+
+				FHitResult Hit;
+				if (!IsDamageableFrom(World, Component, Explosion.Origin, QueryParams, Hit))
+				{
+					continue;
+				}
+
+				// Several components of one actor take the explosion's damage once, like ApplyRadialDamage does
+				FExplosionVictim& VictimDamage = Victims.FindOrAdd(Victim);
+				if (VictimDamage.Explosions.Contains(ExplosionIndex))
+				{
+					continue;
+				}
+				VictimDamage.Explosions.Add(ExplosionIndex);
+				VictimDamage.Damage += Explosion.Damage;
+
+				const float DistanceSquared = FVector::DistSquared(Explosion.Origin, Hit.ImpactPoint);
+				if (DistanceSquared < VictimDamage.NearestDistanceSquared)
+				{
+					VictimDamage.NearestDistanceSquared = DistanceSquared;
+					VictimDamage.NearestExplosion = ExplosionIndex;
+					VictimDamage.Hit = Hit;
+				}
+			}
+		}
+	}
+
+	for (const TPair<AActor*, FExplosionVictim>& Pair : Victims)
+	{
+		AActor* Victim = Pair.Key;
+		const FExplosionVictim& VictimDamage = Pair.Value;
+		const FTrackerBotExplosion& Nearest = Resolving[VictimDamage.NearestExplosion];
+
+		// Full damage, as the bots' explosions have no falloff
+		FRadialDamageEvent DamageEvent;
+		DamageEvent.DamageTypeClass = UDamageType::StaticClass();
+		DamageEvent.Origin = Nearest.Origin;
+		DamageEvent.Params = FRadialDamageParams(VictimDamage.Damage, VictimDamage.Damage, 0.0f, Nearest.Radius, 0.0f);
+		DamageEvent.ComponentHits.Add(VictimDamage.Hit);
+
+		if (!Victim->IsPendingKill())
+		{
+			Victim->TakeDamage(VictimDamage.Damage, DamageEvent, Nearest.InstigatedBy.Get(), Nearest.DamageCauser.Get());
+		}
+	}
+
+	SET_DWORD_STAT(STAT_ExplosionsResolved, Resolving.Num());
+	SET_DWORD_STAT(STAT_ExplosionQueries, Clusters.Num());
+
+	Resolving.Reset();
+}
+
+
+void FTrackerBotExplosions::Reset()
+{
+	Queued.Reset();
+	Resolving.Reset();
+	Clusters.Reset();
+	Traces.Reset();
+}
+
+
+void FTrackerBotExplosions::BuildClusters()
+{
+	Clusters.Reset();
+
+	// Greedy grouping: an explosion joins the first cluster its sphere touches and grows it to contain it
+	for (int32 ExplosionIndex = 0; ExplosionIndex < Resolving.Num(); ExplosionIndex++)
+	{
+		const FTrackerBotExplosion& Explosion = Resolving[ExplosionIndex];
+
+		FTrackerBotExplosionCluster* Joined = nullptr;
+		for (FTrackerBotExplosionCluster& Cluster : Clusters)
+		{
+			if (FVector::DistSquared(Cluster.Center, Explosion.Origin) <= FMath::Square(Cluster.Radius + Explosion.Radius))
+			{
+				Joined = &Cluster;
+				break;
+			}
+		}
+
+		if (!Joined)
+		{
+			FTrackerBotExplosionCluster& Cluster = Clusters[Clusters.AddDefaulted()];
+			Cluster.Center = Explosion.Origin;
+			Cluster.Radius = Explosion.Radius;
+			Cluster.Explosions.Add(ExplosionIndex);
+			continue;
+		}
+
+		// Smallest sphere holding both the cluster and the new explosion's sphere
+		const FVector ToExplosion = Explosion.Origin - Joined->Center;
+		const float Distance = ToExplosion.Size();
+		if (Distance + Explosion.Radius > Joined->Radius)
+		{
+			if (Distance + Joined->Radius <= Explosion.Radius)
+			{
+				Joined->Center = Explosion.Origin;
+				Joined->Radius = Explosion.Radius;
+			}
+			else
+			{
+				const float NewRadius = (Distance + Joined->Radius + Explosion.Radius) * 0.5f;
+				Joined->Center += ToExplosion * ((NewRadius - Joined->Radius) / Distance);
+				Joined->Radius = NewRadius;
+			}
+		}
+		Joined->Explosions.Add(ExplosionIndex);
+	}
+}
+
+
+bool FTrackerBotExplosions::IsDamageableFrom(UWorld* World, UPrimitiveComponent* Component, const FVector& Origin, const FCollisionQueryParams& QueryParams, FHitResult& OutHit)
+{
+	for (const FTrackerBotExplosionTrace& Trace : Traces)
+	{
+		if (Trace.Component.Get() == Component && FVector::DistSquared(Trace.Origin, Origin) <= FMath::Square(TraceShareDistance))
+		{
+			OutHit = Trace.Hit;
+			return Trace.bVisible;
+		}
+	}
+
+	INC_DWORD_STAT(STAT_ExplosionTraces);
+
+	// Same test as ApplyRadialDamage: blocked when the visibility trace to the component's center hits anything else first
+	const FVector TraceEnd = Component->Bounds.Origin;
+	FVector TraceStart = Origin;
+	if (Origin == TraceEnd)
+	{
+		TraceStart.Z += 0.01f;
+	}
+
+	FTrackerBotExplosionTrace& Trace = Traces[Traces.AddDefaulted()];
+	Trace.Component = Component;
+	Trace.Origin = Origin;
+
+	const bool bHadBlockingHit = World->LineTraceSingleByChannel(Trace.Hit, TraceStart, TraceEnd, ECC_Visibility, QueryParams);
+	if (bHadBlockingHit)
+	{
+		Trace.bVisible = Trace.Hit.Component == Component;
+	}
+	else
+	{
+		// Nothing in the way, the damage lands on the component's center
+		const FVector FakeHitNormal = (TraceStart - TraceEnd).GetSafeNormal();
+		Trace.Hit = FHitResult(Component->GetOwner(), Component, TraceEnd, FakeHitNormal);
+		Trace.bVisible = true;
+	}
+
+	OutHit = Trace.Hit;
+	return Trace.bVisible;
+}
@@ -0,0 +1,87 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class AActor;
+class AController;
+class UPrimitiveComponent;
+class UWorld;
+struct FCollisionQueryParams;
+
+// An explosion waiting for the end of the frame
+struct FTrackerBotExplosion
+{
+	FVector Origin;
+
+	float Damage;
+
+	float Radius;
+
+	TWeakObjectPtr<AActor> DamageCauser;
+
+	TWeakObjectPtr<AController> InstigatedBy;
+};
+
+// Explosions whose spheres touch, resolved with one overlap query
+struct FTrackerBotExplosionCluster
+{
+	FVector Center;
+
+	float Radius;
+
+	TArray<int32> Explosions;
+};
+
+// Line of sight already traced from near an origin to a victim component
+struct FTrackerBotExplosionTrace
+{
+	TWeakObjectPtr<UPrimitiveComponent> Component;
+
+	FVector Origin;
+
+	bool bVisible;
+
+	FHitResult Hit;
+};
+
+/**
+ * Resolves the explosions of the tracker bots once per frame instead of once per explosion.
+ * Touching explosions share a single overlap query, the visibility trace to a victim is reused by the explosions going
+ * off close to each other and every victim takes the summed damage of the frame as one radial damage event.
+ * Explosions set off by this frame's damage are resolved on the next frame.
+ */
+class FTrackerBotExplosions
+{
+public:
+
+	FTrackerBotExplosions();
+
+	void QueueExplosion(const FVector& Origin, float Damage, float Radius, AActor* DamageCauser, AController* InstigatedBy);
+
+	void Tick(UWorld* World);
+
+	void Reset();
+
+	int32 GetNumQueued() const { return Queued.Num(); }
+
+	// Explosions going off closer than this to each other share their visibility traces
+	float TraceShareDistance;
+
+protected:
+
+	void BuildClusters();
+
+	// Whether Origin sees Component, from the trace cache when a close enough origin already traced it
+	bool IsDamageableFrom(UWorld* World, UPrimitiveComponent* Component, const FVector& Origin, const FCollisionQueryParams& QueryParams, FHitResult& OutHit);
+
+	TArray<FTrackerBotExplosion> Queued;
+
+	// Explosions of the frame being resolved, new ones are queued separately meanwhile
+	TArray<FTrackerBotExplosion> Resolving;
+
+	TArray<FTrackerBotExplosionCluster> Clusters;
+
+	TArray<FTrackerBotExplosionTrace> Traces;
+};
@@ -0,0 +1,347 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TrackerBotFlowFields.h"
+#include "CooperativeAI.h"
+#include "GameFramework/Pawn.h"
+#include "Engine/World.h"
+#include "AI/Navigation/NavigationSystem.h"
+
+DECLARE_CYCLE_STAT(TEXT("Flow Field Rebuild"), STAT_FlowFieldRebuild, STATGROUP_COOP);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Flow Fields"), STAT_FlowFields, STATGROUP_COOP);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Flow Field Cells Probed"), STAT_FlowFieldCellsProbed, STATGROUP_COOP);
+
+namespace
+{
+	const int32 NumNeighbours = 8;
+
+	const FIntPoint NeighbourOffsets[NumNeighbours] = {
+		FIntPoint(1, 0), FIntPoint(-1, 0), FIntPoint(0, 1), FIntPoint(0, -1),
+		FIntPoint(1, 1), FIntPoint(1, -1), FIntPoint(-1, 1), FIntPoint(-1, -1)
+	};
+
+	// Cost of each step above in cells
+	const float NeighbourCosts[NumNeighbours] = { 1.0f, 1.0f, 1.0f, 1.0f, 1.41421356f, 1.41421356f, 1.41421356f, 1.41421356f };
+
+	struct FOpenCell
+	{
+		int32 Index;
+		float Distance;
+
+		FOpenCell() : Index(INDEX_NONE), Distance(0.0f) {}
+
+		FOpenCell(int32 InIndex, float InDistance) : Index(InIndex), Distance(InDistance) {}
+	};
+
+	struct FOpenCellPredicate
+	{
+		bool operator()(const FOpenCell& A, const FOpenCell& B) const { return A.Distance < B.Distance; }
+	};
+}
+
+
+FTrackerBotFlowFields::FTrackerBotFlowFields()
+{
+	CellSize = 200.0f;
+	GridSize = 64;
+}
+
+
+void FTrackerBotFlowFields::Tick(UWorld* World, const TArray<APawn*>& Players, int32 MaxRebuilds)
+{
+	// Drop the fields of players that died or left
+	for (int32 FieldIndex = Fields.Num() - 1; FieldIndex >= 0; FieldIndex--)
+	{
+		APawn* Player = Fields[FieldIndex].Player.Get();
+		if (Player == nullptr || !Players.Contains(Player))
+		{
+			Fields.RemoveAtSwap(FieldIndex, 1, false);
+		}
+	}
+
+	for (APawn* Player : Players)
+	{
+		if (Player == nullptr)
+		{
+			continue;
+		}
+
+		FPlayerFlowField* Field = Fields.FindByPredicate([Player](const FPlayerFlowField& Candidate) { return Candidate.Player.Get() == Player; });
+		if (Field == nullptr)
+		{
+			Field = &Fields[Fields.AddDefaulted()];
+			Field->Player = Player;
+			Field->bDirty = true;
+		}
+
+		const FIntPoint PlayerCell = GetCell(Player->GetActorLocation());
+		if (PlayerCell != Field->GoalCell || Field->Distances.Num() == 0)
+		{
+			Field->GoalCell = PlayerCell;
+			Field->bDirty = true;
+		}
+	}
+
+	int32 NumRebuilt = 0;
+	for (FPlayerFlowField& Field : Fields)
+	{
+		if (Field.bDirty && NumRebuilt < MaxRebuilds)
+		{
+			Build(World, Field, Field.Player->GetActorLocation().Z);
+			NumRebuilt++;
+		}
+	}
+
+	SET_DWORD_STAT(STAT_FlowFields, Fields.Num());
+}
+
+
+void FTrackerBotFlowFields::Reset()
+{
+	Fields.Reset();
+	CellCache.Reset();
+}
+
+
+bool FTrackerBotFlowFields::CanReach(const APawn* Player, const FVector& Location) const
+{
+	const FPlayerFlowField* Field = FindField(Player);
+	if (Field == nullptr)
+	{
+		return false;
+	}
+
+	const int32 Index = GetFieldIndex(*Field, GetCell(Location));
+	return Index != INDEX_NONE && Field->Distances[Index] < FLT_MAX;
+}
+
+
+bool FTrackerBotFlowFields::GetNextStep(const APawn* Player, const FVector& Location, FVector& OutStep) const
+{
+	const FPlayerFlowField* Field = FindField(Player);
+	if (Field == nullptr)
+	{
+		return false;
+	}
+
+	const FIntPoint Cell = GetCell(Location);
+	const int32 Index = GetFieldIndex(*Field, Cell);
+	if (Index == INDEX_NONE || Field->Distances[Index] == FLT_MAX)
+	{
+		return false;
+	}
+
+	// In the player's cell, the rest is a straight line
+	if (Cell == Field->GoalCell)
+	{
+		OutStep = Player->GetActorLocation();
+		return true;
+	}
+
+	float BestDistance = Field->Distances[Index];
+	int32 BestNeighbour = INDEX_NONE;
+	for (int32 Neighbour = 0; Neighbour < NumNeighbours; Neighbour++)
+	{
+		const int32 NeighbourIndex = GetFieldIndex(*Field, Cell + NeighbourOffsets[Neighbour]);
+		if (NeighbourIndex != INDEX_NONE && Field->Distances[NeighbourIndex] < BestDistance && IsDiagonalClear(Cell, NeighbourOffsets[Neighbour]))
+		{
+			BestDistance = Field->Distances[NeighbourIndex];
+			BestNeighbour = Neighbour;
+		}
+	}
+
+	if (BestNeighbour == INDEX_NONE)
+	{
+		return false;
+	}
+
+	OutStep = CellCache.FindChecked(Cell + NeighbourOffsets[BestNeighbour]).Location;
+	return true;
+}
+
+
+bool FTrackerBotFlowFields::GetStepTowards(const APawn* Player, const FVector& Location, const FVector& Goal, FVector& OutStep) const
+{
+	const FPlayerFlowField* Field = FindField(Player);
+	if (Field == nullptr)
+	{
+		return false;
+	}
+
+	const FIntPoint Cell = GetCell(Location);
+	const FIntPoint GoalCell = GetCell(Goal);
+	if (GetFieldIndex(*Field, Cell) == INDEX_NONE || Cell == GoalCell)
+	{
+		return false;
+	}
+
+	// Greedy over the reachable cells, the field itself decides which cells can be walked through
+	int32 BestGoalDistance = (GoalCell - Cell).SizeSquared();
+	int32 BestNeighbour = INDEX_NONE;
+	for (int32 Neighbour = 0; Neighbour < NumNeighbours; Neighbour++)
+	{
+		const FIntPoint NeighbourCell = Cell + NeighbourOffsets[Neighbour];
+		const int32 NeighbourIndex = GetFieldIndex(*Field, NeighbourCell);
+		if (NeighbourIndex == INDEX_NONE || Field->Distances[NeighbourIndex] == FLT_MAX || !IsDiagonalClear(Cell, NeighbourOffsets[Neighbour]))
+		{
+			continue;
+		}
+
+		const int32 GoalDistance = (GoalCell - NeighbourCell).SizeSquared();
+		if (GoalDistance < BestGoalDistance)
+		{
+			BestGoalDistance = GoalDistance;
+			BestNeighbour = Neighbour;
+		}
+	}
+
+	if (BestNeighbour == INDEX_NONE)
+	{
+		return false;
+	}
+
+	OutStep = CellCache.FindChecked(Cell + NeighbourOffsets[BestNeighbour]).Location;
+	return true;
+}
+
+
+const FPlayerFlowField* FTrackerBotFlowFields::FindField(const APawn* Player) const
+{
+	for (const FPlayerFlowField& Field : Fields)
+	{
+		if (Field.Player.Get() == Player && Field.Distances.Num() > 0)
+		{
+			return &Field;
+		}
+	}
+	return nullptr;
+}
+
+
+FIntPoint FTrackerBotFlowFields::GetCell(const FVector& Location) const
+{
+	return FIntPoint(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize));
+}
+
+
+int32 FTrackerBotFlowFields::GetFieldIndex(const FPlayerFlowField& Field, const FIntPoint& Cell) const
+{
+	const FIntPoint Local = Cell - Field.OriginCell;
+	if (Local.X < 0 || Local.Y < 0 || Local.X >= GridSize || Local.Y >= GridSize)
+	{
+		return INDEX_NONE;
+	}
+	return Local.Y * GridSize + Local.X;
+}
+
+
+FVector FTrackerBotFlowFields::GetCellCenter(const FIntPoint& Cell) const
+{
+	return FVector((Cell.X + 0.5f) * CellSize, (Cell.Y + 0.5f) * CellSize, 0.0f);
+}
+
+
+bool FTrackerBotFlowFields::IsDiagonalClear(const FIntPoint& Cell, const FIntPoint& Offset) const
+{
+	if (Offset.X == 0 || Offset.Y == 0)
+	{
+		return true;
+	}
+
+	const FFlowFieldCell* SideX = CellCache.Find(Cell + FIntPoint(Offset.X, 0));
+	const FFlowFieldCell* SideY = CellCache.Find(Cell + FIntPoint(0, Offset.Y));
+	return SideX && SideX->bWalkable && SideY && SideY->bWalkable;
+}
+
+
+const FFlowFieldCell& FTrackerBotFlowFields::GetCellData(UWorld* World, const FIntPoint& Cell, float ProbeZ)
+{
+	FFlowFieldCell* CellData = CellCache.Find(Cell);
+	if (CellData)
+	{
+		return *CellData;
+	}
+
+	INC_DWORD_STAT(STAT_FlowFieldCellsProbed);
+
+	FVector Center = GetCellCenter(Cell);
+	Center.Z = ProbeZ;
+
+	FFlowFieldCell NewCell;
+	NewCell.bWalkable = false;
+	NewCell.Location = Center;
+
+	// The projection may move the point anywhere within the cell, the center itself can be inside geometry
+	UNavigationSystem* NavSys = World->GetNavigationSystem();
+	FNavLocation NavLocation;
+	const FVector Extent(CellSize * 0.5f, CellSize * 0.5f, 500.0f);
+	if (NavSys && NavSys->ProjectPointToNavigation(Center, NavLocation, Extent))
+	{
+		NewCell.bWalkable = true;
+		NewCell.Location = NavLocation.Location;
+	}
+
+	return CellCache.Add(Cell, NewCell);
+}
+
+
+void FTrackerBotFlowFields::Build(UWorld* World, FPlayerFlowField& Field, float ProbeZ)
+{
+	COOP_SCOPE_CYCLE_COUNTER(STAT_FlowFieldRebuild, FlowFields);
+
+	Field.bDirty = false;
+	Field.OriginCell = Field.GoalCell - FIntPoint(GridSize / 2, GridSize / 2);
+	Field.Distances.Init(FLT_MAX, GridSize * GridSize);
+
+	TArray<FOpenCell> Open;
+	const int32 GoalIndex = GetFieldIndex(Field, Field.GoalCell);
+	Field.Distances[GoalIndex] = 0.0f;
+	Open.HeapPush(FOpenCell(GoalIndex, 0.0f), FOpenCellPredicate());
+
+	while (Open.Num() > 0)
+	{
+		FOpenCell Current;
+		Open.HeapPop(Current, FOpenCellPredicate(), false);
+		if (Current.Distance > Field.Distances[Current.Index])
+		{
+			continue;
+		}
+
+		const FIntPoint Cell = Field.OriginCell + FIntPoint(Current.Index % GridSize, Current.Index / GridSize);
+		const float CellZ = GetCellData(World, Cell, ProbeZ).Location.Z;
+
+		for (int32 Neighbour = 0; Neighbour < NumNeighbours; Neighbour++)
+		{
+			const FIntPoint NeighbourCell = Cell + NeighbourOffsets[Neighbour];
+			const int32 NeighbourIndex = GetFieldIndex(Field, NeighbourCell);
+			if (NeighbourIndex == INDEX_NONE)
+			{
+				continue;
+			}
+
+			// Probe the cells beside a diagonal step before the references below
+			if (Neighbour >= 4)
+			{
+				GetCellData(World, Cell + FIntPoint(NeighbourOffsets[Neighbour].X, 0), ProbeZ);
+				GetCellData(World, Cell + FIntPoint(0, NeighbourOffsets[Neighbour].Y), ProbeZ);
+				if (!IsDiagonalClear(Cell, NeighbourOffsets[Neighbour]))
+				{
+					continue;
+				}
+			}
+
+			// Steps higher than a cell are walls or ledges
+			const FFlowFieldCell& NeighbourData = GetCellData(World, NeighbourCell, ProbeZ);
+			if (!NeighbourData.bWalkable || FMath::Abs(NeighbourData.Location.Z - CellZ) > CellSize)
+			{
+				continue;
+			}
+
+			const float Distance = Current.Distance + NeighbourCosts[Neighbour] * CellSize;
+			if (Distance < Field.Distances[NeighbourIndex])
+			{
+				Field.Distances[NeighbourIndex] = Distance;
+				Open.HeapPush(FOpenCell(NeighbourIndex, Distance), FOpenCellPredicate());
+			}
+		}
+	}
+}
@@ -0,0 +1,90 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class APawn;
+class UWorld;
+
+// Navmesh sample of one grid cell, probed once and cached for the rest of the match
+struct FFlowFieldCell
+{
+	bool bWalkable;
+
+	// Navmesh point nearest the cell center, where bots stepping into the cell head for
+	FVector Location;
+};
+
+// Path distance of every cell of a square grid around one player, 0 at the player's cell and FLT_MAX where it cannot be reached
+struct FPlayerFlowField
+{
+	TWeakObjectPtr<APawn> Player;
+
+	// World cell of the grid's first entry, and of the player when the field was built
+	FIntPoint OriginCell;
+	FIntPoint GoalCell;
+
+	TArray<float> Distances;
+
+	bool bDirty;
+};
+
+/**
+ * One flow field per living player, shared by every tracker bot.
+ * A field is only rebuilt when its player moves to another cell, so the pathing cost follows the number of players;
+ * a bot reads its next step from the field around its target in O(1) instead of running a path query.
+ * Cells are probed on the navmesh at a single height, the fields assume a mostly flat arena and bots fall back to
+ * path queries anywhere outside them.
+ */
+class FTrackerBotFlowFields
+{
+public:
+
+	FTrackerBotFlowFields();
+
+	// Keeps one field per player and rebuilds at most MaxRebuilds of the ones whose player changed cell
+	void Tick(UWorld* World, const TArray<APawn*>& Players, int32 MaxRebuilds);
+
+	void Reset();
+
+	// Whether Location is inside Player's field and can reach the player through it
+	bool CanReach(const APawn* Player, const FVector& Location) const;
+
+	// Navmesh point of the next cell on the shortest way from Location to Player
+	bool GetNextStep(const APawn* Player, const FVector& Location, FVector& OutStep) const;
+
+	// Navmesh point of the next cell bringing Location closer to Goal while staying reachable from Player's field. False once at Goal or when no neighbour is closer
+	bool GetStepTowards(const APawn* Player, const FVector& Location, const FVector& Goal, FVector& OutStep) const;
+
+	// Size of the grid cells in world units
+	float CellSize;
+
+	// Cells along each side of a field
+	int32 GridSize;
+
+protected:
+
+	const FPlayerFlowField* FindField(const APawn* Player) const;
+
+	FIntPoint GetCell(const FVector& Location) const;
+
+	// Index of a world cell in the field's grid, INDEX_NONE outside of it
+	int32 GetFieldIndex(const FPlayerFlowField& Field, const FIntPoint& Cell) const;
+
+	FVector GetCellCenter(const FIntPoint& Cell) const;
+
+	// A diagonal step is only taken when both cells beside it are walkable, so paths do not cut corners. Needs both cells probed
+	bool IsDiagonalClear(const FIntPoint& Cell, const FIntPoint& Offset) const;
+
+	// Probes the navmesh the first time a cell is used
+	const FFlowFieldCell& GetCellData(UWorld* World, const FIntPoint& Cell, float ProbeZ);
+
+	// Dijkstra over the 8 neighbours of every walkable cell, starting from the player's cell.
+	// Always the whole grid: moving the root changes the distance of every cell, so re-relaxing from the changed cells would touch them all anyway
+	void Build(UWorld* World, FPlayerFlowField& Field, float ProbeZ);
+
+	TArray<FPlayerFlowField> Fields;
+
+	TMap<FIntPoint, FFlowFieldCell> CellCache;
+};
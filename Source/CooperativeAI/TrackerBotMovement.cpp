@@ -0,0 +1,119 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TrackerBotMovement.h"
+#include "CooperativeAI.h"
+#include "Async/ParallelFor.h"
+#include "TrackerBotRegistry.h"
+#include "STrackerBot.h"
+
+// Bots steered by one worker task
+#define MOVEMENT_BATCH_SIZE 128
+
+DECLARE_CYCLE_STAT(TEXT("Bot Movement"), STAT_BotMovement, STATGROUP_COOP);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Bots Steered"), STAT_BotsSteered, STATGROUP_COOP);
+
+
+void FTrackerBotMovement::Tick(float DeltaSeconds, const FTrackerBotRegistry& Registry)
+{
+	COOP_SCOPE_CYCLE_COUNTER(STAT_BotMovement, Movement);
+
+	Reset();
+
+	// Gather the bots due an update into the columns
+	for (ASTrackerBot* Bot : Registry.GetBots())
+	{
+		if (!Bot->IsMovementActive())
+		{
+			continue;
+		}
+
+		Bot->MovementTimeAccumulated += DeltaSeconds;
+		if (Bot->MovementTimeAccumulated < Bot->MovementInterval)
+		{
+			continue;
+		}
+
+		const FVector Position = Bot->GetActorLocation();
+
+		Bots.Add(Bot);
+		DeltaTimes.Add(Bot->MovementTimeAccumulated);
+		PositionX.Add(Position.X);
+		PositionY.Add(Position.Y);
+		PositionZ.Add(Position.Z);
+		TargetX.Add(Bot->NextPathPoint.X);
+		TargetY.Add(Bot->NextPathPoint.Y);
+		TargetZ.Add(Bot->NextPathPoint.Z);
+		MovementForces.Add(Bot->MovementForce);
+		ReachDistancesSquared.Add(FMath::Square(Bot->RequiredDistanceToTarget));
+
+		Bot->MovementTimeAccumulated = 0.0f;
+	}
+
+	const int32 NumBots = Bots.Num();
+	ForceX.SetNumUninitialized(NumBots);
+	ForceY.SetNumUninitialized(NumBots);
+	ForceZ.SetNumUninitialized(NumBots);
+	Reached.SetNumUninitialized(NumBots);
+
+	const int32 NumBatches = FMath::DivideAndRoundUp(NumBots, MOVEMENT_BATCH_SIZE);
+	ParallelFor(NumBatches, [this, NumBots](int32 Batch)
+	{
+		const int32 FirstBot = Batch * MOVEMENT_BATCH_SIZE;
+		ComputeSteering(FirstBot, FMath::Min(FirstBot + MOVEMENT_BATCH_SIZE, NumBots));
+	}, NumBatches <= 1);
+
+	// Back on the game thread, push the bodies
+	for (int32 BotIndex = 0; BotIndex < NumBots; BotIndex++)
+	{
+		ASTrackerBot* Bot = Bots[BotIndex];
+		if (Reached[BotIndex])
+		{
+			Bot->OnPathPointReached();
+		}
+		else
+		{
+			Bot->ApplySteering(FVector(ForceX[BotIndex], ForceY[BotIndex], ForceZ[BotIndex]), DeltaTimes[BotIndex]);
+		}
+	}
+
+	SET_DWORD_STAT(STAT_BotsSteered, NumBots);
+}
+
+
+void FTrackerBotMovement::Reset()
+{
+	Bots.Reset();
+	DeltaTimes.Reset();
+	PositionX.Reset();
+	PositionY.Reset();
+	PositionZ.Reset();
+	TargetX.Reset();
+	TargetY.Reset();
+	TargetZ.Reset();
+	MovementForces.Reset();
+	ReachDistancesSquared.Reset();
+	ForceX.Reset();
+	ForceY.Reset();
+	ForceZ.Reset();
+	Reached.Reset();
+}
+
+
+void FTrackerBotMovement::ComputeSteering(int32 FirstBot, int32 LastBot)
+{
+	// Plain arithmetic over the columns so the compiler can vectorize it
+	for (int32 BotIndex = FirstBot; BotIndex < LastBot; BotIndex++)
+	{
+		const float DirectionX = TargetX[BotIndex] - PositionX[BotIndex];
+		const float DirectionY = TargetY[BotIndex] - PositionY[BotIndex];
+		const float DirectionZ = TargetZ[BotIndex] - PositionZ[BotIndex];
+		const float DistanceSquared = DirectionX * DirectionX + DirectionY * DirectionY + DirectionZ * DirectionZ;
+
+		Reached[BotIndex] = DistanceSquared <= ReachDistancesSquared[BotIndex] ? 1 : 0;
+
+		const float Scale = DistanceSquared > SMALL_NUMBER ? MovementForces[BotIndex] * FMath::InvSqrt(DistanceSquared) : 0.0f;
+		ForceX[BotIndex] = DirectionX * Scale;
+		ForceY[BotIndex] = DirectionY * Scale;
+		ForceZ[BotIndex] = DirectionZ * Scale;
+	}
+}
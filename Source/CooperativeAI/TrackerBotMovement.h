@@ -0,0 +1,53 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class ASTrackerBot;
+class FTrackerBotRegistry;
+
+/**
+ * Steers every tracker bot from one tick instead of a tick function per bot.
+ * The bots due an update are gathered into parallel columns, the steering forces are computed for all of them at once
+ * on the worker threads and then applied to the bodies in a single loop on the game thread.
+ */
+class FTrackerBotMovement
+{
+public:
+
+	// Steers the bots of the registry whose LOD tier is due an update this frame
+	void Tick(float DeltaSeconds, const FTrackerBotRegistry& Registry);
+
+	void Reset();
+
+	int32 GetNumSteered() const { return Bots.Num(); }
+
+protected:
+
+	// Direction and force towards each bot's next path point, or whether the bot reached it
+	void ComputeSteering(int32 FirstBot, int32 LastBot);
+
+	TArray<ASTrackerBot*> Bots;
+
+	// Time each bot is steered for, longer than a frame for the bots of the lower LOD tiers
+	TArray<float> DeltaTimes;
+
+	TArray<float> PositionX;
+	TArray<float> PositionY;
+	TArray<float> PositionZ;
+
+	TArray<float> TargetX;
+	TArray<float> TargetY;
+	TArray<float> TargetZ;
+
+	TArray<float> MovementForces;
+
+	TArray<float> ReachDistancesSquared;
+
+	TArray<float> ForceX;
+	TArray<float> ForceY;
+	TArray<float> ForceZ;
+
+	TArray<uint8> Reached;
+};
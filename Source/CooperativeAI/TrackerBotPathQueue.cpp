@@ -0,0 +1,220 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TrackerBotPathQueue.h"
+#include "CooperativeAI.h"
+#include "STrackerBot.h"
+
+DECLARE_CYCLE_STAT(TEXT("Path Queue"), STAT_PathQueue, STATGROUP_COOP);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Path Request Queue"), STAT_PathRequestQueue, STATGROUP_COOP);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Path Queries Started"), STAT_PathQueriesStarted, STATGROUP_COOP);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Path Cache Hits"), STAT_PathCacheHits, STATGROUP_COOP);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Path Cache Misses"), STAT_PathCacheMisses, STATGROUP_COOP);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Path Cache Entries"), STAT_PathCacheEntries, STATGROUP_COOP);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Path Cache Hit Rate"), STAT_PathCacheHitRate, STATGROUP_COOP);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Path Queries/s"), STAT_PathQueriesPerSecond, STATGROUP_COOP);
+
+
+FTrackerBotPathQueue::FTrackerBotPathQueue()
+{
+	NumAngleBuckets = 20;
+	StartCellSize = 500.0f;
+	CacheLifetime = 2.0f;
+	TargetMoveThreshold = 150.0f;
+	CacheHits = 0;
+	CacheMisses = 0;
+	NumQueriesStarted = 0;
+	CurrentTime = 0.0f;
+	QueriesInWindow = 0;
+	QueriesPerSecond = 0.0f;
+	QueryRateWindowStart = FPlatformTime::Seconds();
+}
+
+
+void FTrackerBotPathQueue::RequestPath(ASTrackerBot* Bot)
+{
+	if (Bot == nullptr || Bot->HasPathRequest())
+	{
+		return;
+	}
+
+	Bot->bPathQueued = true;
+	Queue.Add(Bot);
+}
+
+
+void FTrackerBotPathQueue::Tick(float WorldTime, double BudgetSeconds)
+{
+	COOP_SCOPE_CYCLE_COUNTER(STAT_PathQueue, PathQueue);
+
+	const double StartTime = FPlatformTime::Seconds();
+	CurrentTime = WorldTime;
+
+	// Forget old paths, and give up on queries whose bot left before the answer came back
+	for (auto It = Cache.CreateIterator(); It; ++It)
+	{
+		if (CurrentTime - It->Value.StartTime > CacheLifetime)
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	for (auto It = PendingQueries.CreateIterator(); It; ++It)
+	{
+		if (CurrentTime - It->Value.StartTime > CacheLifetime)
+		{
+			for (const TWeakObjectPtr<ASTrackerBot>& Waiter : It->Value.Waiters)
+			{
+				if (Waiter.IsValid() && Waiter->PendingPathQuery == It->Key)
+				{
+					Waiter->PendingPathQuery = INVALID_NAVQUERYID;
+					RequestPath(Waiter.Get());
+				}
+			}
+			It.RemoveCurrent();
+		}
+	}
+
+	int32 NumProcessed = 0;
+	int32 NumStarted = 0;
+	while (NumProcessed < Queue.Num())
+	{
+		ASTrackerBot* Bot = Queue[NumProcessed++].Get();
+
+		// Bots sent back to the pool since they asked have their flag cleared
+		if (Bot && Bot->bPathQueued)
+		{
+			// Cache hits cost no navigation query and are not counted as one
+			if (Bot->StartPathQuery(*this))
+			{
+				NumStarted++;
+			}
+
+			if ((FPlatformTime::Seconds() - StartTime) >= BudgetSeconds)
+			{
+				break;
+			}
+		}
+	}
+	Queue.RemoveAt(0, NumProcessed, false);
+
+	NumQueriesStarted += NumStarted;
+	QueriesInWindow += NumStarted;
+	if (StartTime - QueryRateWindowStart >= 1.0)
+	{
+		QueriesPerSecond = QueriesInWindow / (float)(StartTime - QueryRateWindowStart);
+		QueryRateWindowStart = StartTime;
+		QueriesInWindow = 0;
+	}
+
+	SET_DWORD_STAT(STAT_PathRequestQueue, Queue.Num());
+	SET_DWORD_STAT(STAT_PathQueriesStarted, NumStarted);
+	SET_DWORD_STAT(STAT_PathCacheEntries, Cache.Num());
+	SET_FLOAT_STAT(STAT_PathQueriesPerSecond, QueriesPerSecond);
+	SET_FLOAT_STAT(STAT_PathCacheHitRate, (CacheHits + CacheMisses) > 0 ? (float)CacheHits / (CacheHits + CacheMisses) : 0.0f);
+}
+
+
+void FTrackerBotPathQueue::Reset()
+{
+	Queue.Reset();
+	Cache.Reset();
+	PendingQueries.Reset();
+	CacheHits = 0;
+	CacheMisses = 0;
+	NumQueriesStarted = 0;
+	QueriesInWindow = 0;
+	QueriesPerSecond = 0.0f;
+	QueryRateWindowStart = FPlatformTime::Seconds();
+}
+
+
+FTrackerBotPathKey FTrackerBotPathQueue::MakeKey(const AActor* Target, float AttackAngle, bool bAngled, const FVector& Start) const
+{
+	FTrackerBotPathKey Key;
+	Key.TargetId = Target ? Target->GetUniqueID() : 0;
+	Key.AngleBucket = bAngled ? FMath::RoundToInt(AttackAngle * NumAngleBuckets / 360.0f) % FMath::Max(NumAngleBuckets, 1) : INDEX_NONE;
+	Key.StartCell = FIntPoint(FMath::FloorToInt(Start.X / StartCellSize), FMath::FloorToInt(Start.Y / StartCellSize));
+	return Key;
+}
+
+
+bool FTrackerBotPathQueue::FindCachedPath(const FTrackerBotPathKey& Key, const FVector& TargetLocation, ASTrackerBot* Bot)
+{
+	FTrackerBotCachedPath* CachedPath = Cache.Find(Key);
+	if (CachedPath && FVector::DistSquared(CachedPath->TargetLocation, TargetLocation) > FMath::Square(TargetMoveThreshold))
+	{
+		Cache.Remove(Key);
+		CachedPath = nullptr;
+	}
+
+	if (CachedPath == nullptr)
+	{
+		CacheMisses++;
+		INC_DWORD_STAT(STAT_PathCacheMisses);
+		return false;
+	}
+
+	CacheHits++;
+	INC_DWORD_STAT(STAT_PathCacheHits);
+
+	if (CachedPath->PendingQuery != INVALID_NAVQUERYID)
+	{
+		FTrackerBotPendingQuery* PendingQuery = PendingQueries.Find(CachedPath->PendingQuery);
+		if (PendingQuery)
+		{
+			Bot->PendingPathQuery = CachedPath->PendingQuery;
+			PendingQuery->Waiters.Add(Bot);
+			return true;
+		}
+
+		// The query was given up on, run a new one
+		Cache.Remove(Key);
+		return false;
+	}
+
+	Bot->FollowPath(CachedPath->Result, CachedPath->Path);
+	return true;
+}
+
+
+void FTrackerBotPathQueue::AddPendingQuery(const FTrackerBotPathKey& Key, uint32 QueryID, const FVector& TargetLocation)
+{
+	const float Now = CurrentTime;
+
+	FTrackerBotPendingQuery& PendingQuery = PendingQueries.Add(QueryID);
+	PendingQuery.Key = Key;
+	PendingQuery.StartTime = Now;
+
+	FTrackerBotCachedPath& CachedPath = Cache.Add(Key);
+	CachedPath.Result = ENavigationQueryResult::Invalid;
+	CachedPath.TargetLocation = TargetLocation;
+	CachedPath.StartTime = Now;
+	CachedPath.PendingQuery = QueryID;
+}
+
+
+void FTrackerBotPathQueue::OnPathFound(uint32 QueryID, ENavigationQueryResult::Type Result, FNavPathSharedPtr Path)
+{
+	FTrackerBotPendingQuery PendingQuery;
+	if (!PendingQueries.RemoveAndCopyValue(QueryID, PendingQuery))
+	{
+		return;
+	}
+
+	// Only if no newer query replaced the entry in the meantime
+	FTrackerBotCachedPath* CachedPath = Cache.Find(PendingQuery.Key);
+	if (CachedPath && CachedPath->PendingQuery == QueryID)
+	{
+		CachedPath->Path = Path;
+		CachedPath->Result = Result;
+		CachedPath->PendingQuery = INVALID_NAVQUERYID;
+	}
+
+	for (const TWeakObjectPtr<ASTrackerBot>& Waiter : PendingQuery.Waiters)
+	{
+		if (Waiter.IsValid())
+		{
+			Waiter->ReceivePath(QueryID, Result, Path);
+		}
+	}
+}
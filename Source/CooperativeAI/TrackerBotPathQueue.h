@@ -0,0 +1,132 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AI/Navigation/NavigationTypes.h"
+
+class ASTrackerBot;
+
+// Bots asking for the same target, attack angle bucket and coarse start cell share one path
+struct FTrackerBotPathKey
+{
+	uint32 TargetId;
+
+	// INDEX_NONE for paths straight to the target
+	int32 AngleBucket;
+
+	FIntPoint StartCell;
+
+	bool operator==(const FTrackerBotPathKey& Other) const
+	{
+		return TargetId == Other.TargetId && AngleBucket == Other.AngleBucket && StartCell == Other.StartCell;
+	}
+
+	friend uint32 GetTypeHash(const FTrackerBotPathKey& Key)
+	{
+		return HashCombine(HashCombine(Key.TargetId, GetTypeHash(Key.AngleBucket)), GetTypeHash(Key.StartCell));
+	}
+};
+
+// A computed path, or the query still computing it
+struct FTrackerBotCachedPath
+{
+	FNavPathSharedPtr Path;
+
+	ENavigationQueryResult::Type Result;
+
+	// Where the target was when the query started
+	FVector TargetLocation;
+
+	// World time, so pauses and hitches do not age the entry
+	float StartTime;
+
+	// Query filling this entry, INVALID_NAVQUERYID once answered
+	uint32 PendingQuery;
+};
+
+// Bots waiting on a query started by another bot with the same key
+struct FTrackerBotPendingQuery
+{
+	FTrackerBotPathKey Key;
+
+	// World time the query was started at
+	float StartTime;
+
+	TArray<TWeakObjectPtr<ASTrackerBot>> Waiters;
+};
+
+/**
+ * Central queue of the tracker bots' path requests.
+ * Requests are started as async navigation queries in request order, only as many per frame as the time budget allows,
+ * and the results come back to the bots on a later tick. A bot that already has a request queued or in flight is not queued again.
+ * Answers are kept for a short while per target, attack angle bucket and coarse start cell, so bots sharing an approach
+ * follow one corridor instead of each running a query of their own.
+ */
+class FTrackerBotPathQueue
+{
+public:
+
+	FTrackerBotPathQueue();
+
+	void RequestPath(ASTrackerBot* Bot);
+
+	// Starts queued queries until BudgetSeconds of wall clock time is spent, always at least one, and forgets paths expired in game time
+	void Tick(float WorldTime, double BudgetSeconds);
+
+	void Reset();
+
+	int32 Num() const { return Queue.Num(); }
+
+	FTrackerBotPathKey MakeKey(const AActor* Target, float AttackAngle, bool bAngled, const FVector& Start) const;
+
+	// Answers the bot from the cache or makes it wait on a query already computing the same path. False on a miss, the bot then runs its own query
+	bool FindCachedPath(const FTrackerBotPathKey& Key, const FVector& TargetLocation, ASTrackerBot* Bot);
+
+	// Records the query a bot started after a miss so others can wait on it
+	void AddPendingQuery(const FTrackerBotPathKey& Key, uint32 QueryID, const FVector& TargetLocation);
+
+	// Fills the cache and answers the bots waiting on the query
+	void OnPathFound(uint32 QueryID, ENavigationQueryResult::Type Result, FNavPathSharedPtr Path);
+
+	int32 GetCacheHits() const { return CacheHits; }
+
+	int32 GetCacheMisses() const { return CacheMisses; }
+
+	// Async navigation queries started since the last reset, requests answered from the cache are counted in GetCacheHits
+	int32 GetNumQueriesStarted() const { return NumQueriesStarted; }
+
+	// Attack angle buckets around a target, the swarm's number of angles
+	int32 NumAngleBuckets;
+
+	// Size of the start cells in world units
+	float StartCellSize;
+
+	// Seconds of game time a path is reused for, and an async query is waited on
+	float CacheLifetime;
+
+	// A path is dropped once its target moved further than this from where it was when the query started
+	float TargetMoveThreshold;
+
+protected:
+
+	TArray<TWeakObjectPtr<ASTrackerBot>> Queue;
+
+	TMap<FTrackerBotPathKey, FTrackerBotCachedPath> Cache;
+
+	TMap<uint32, FTrackerBotPendingQuery> PendingQueries;
+
+	int32 CacheHits;
+
+	int32 CacheMisses;
+
+	int32 NumQueriesStarted;
+
+	// World time of the current tick
+	float CurrentTime;
+
+	// Requests started over the last second
+	double QueryRateWindowStart;
+	int32 QueriesInWindow;
+	float QueriesPerSecond;
+};
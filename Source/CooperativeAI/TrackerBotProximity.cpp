@@ -0,0 +1,103 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TrackerBotProximity.h"
+#include "CooperativeAI.h"
+#include "GameFramework/Pawn.h"
+#include "TrackerBotRegistry.h"
+#include "STrackerBot.h"
+
+DECLARE_CYCLE_STAT(TEXT("Bot Proximity"), STAT_BotProximity, STATGROUP_COOP);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Proximity Tests"), STAT_ProximityTests, STATGROUP_COOP);
+
+
+FTrackerBotProximity::FTrackerBotProximity()
+{
+	CellSize = 400.0f;
+}
+
+
+void FTrackerBotProximity::Tick(const FTrackerBotRegistry& Registry, const TArray<APawn*>& Players)
+{
+	COOP_SCOPE_CYCLE_COUNTER(STAT_BotProximity, Proximity);
+
+	Reset();
+
+	if (Players.Num() == 0)
+	{
+		return;
+	}
+
+	for (int32 PlayerIndex = 0; PlayerIndex < Players.Num(); PlayerIndex++)
+	{
+		PlayerCells.FindOrAdd(GetCell(Players[PlayerIndex]->GetActorLocation())).Add(PlayerIndex);
+	}
+
+	int32 NumTests = 0;
+	for (ASTrackerBot* Bot : Registry.GetBots())
+	{
+		if (!Bot->CanTriggerOnPlayers())
+		{
+			continue;
+		}
+
+		const FVector BotLocation = Bot->GetActorLocation();
+		const FIntVector BotCell = GetCell(BotLocation);
+		const float RadiusSquared = FMath::Square(Bot->GetProximityRadius());
+
+		APawn* NearestPlayer = nullptr;
+		float NearestDistanceSquared = RadiusSquared;
+
+		// A radius up to CellSize never reaches past the neighbouring cells
+		for (int32 X = -1; X <= 1; X++)
+		{
+			for (int32 Y = -1; Y <= 1; Y++)
+			{
+				for (int32 Z = -1; Z <= 1; Z++)
+				{
+					const TArray<int32>* CellPlayers = PlayerCells.Find(BotCell + FIntVector(X, Y, Z));
+					if (!CellPlayers)
+					{
+						continue;
+					}
+
+					for (int32 PlayerIndex : *CellPlayers)
+					{
+						NumTests++;
+						const float DistanceSquared = FVector::DistSquared(Players[PlayerIndex]->GetActorLocation(), BotLocation);
+						if (DistanceSquared <= NearestDistanceSquared)
+						{
+							NearestDistanceSquared = DistanceSquared;
+							NearestPlayer = Players[PlayerIndex];
+						}
+					}
+				}
+			}
+		}
+
+		if (NearestPlayer)
+		{
+			Triggered.Add(TPair<ASTrackerBot*, APawn*>(Bot, NearestPlayer));
+		}
+	}
+
+	// Triggering changes the registry states, so it waits until the pass is over
+	for (const TPair<ASTrackerBot*, APawn*>& Trigger : Triggered)
+	{
+		Trigger.Key->OnPlayerInRange(Trigger.Value);
+	}
+
+	SET_DWORD_STAT(STAT_ProximityTests, NumTests);
+}
+
+
+void FTrackerBotProximity::Reset()
+{
+	PlayerCells.Reset();
+	Triggered.Reset();
+}
+
+
+FIntVector FTrackerBotProximity::GetCell(const FVector& Location) const
+{
+	return FIntVector(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize), FMath::FloorToInt(Location.Z / CellSize));
+}
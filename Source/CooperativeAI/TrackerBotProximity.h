@@ -0,0 +1,38 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class APawn;
+class ASTrackerBot;
+class FTrackerBotRegistry;
+
+/**
+ * Finds the tracker bots that came close enough to a player to start their self destruct.
+ * The few player positions are hashed into a coarse grid every tick and each hunting bot only tests the players of
+ * the cells around it, so the bots need no overlap component and never generate overlaps against each other.
+ */
+class FTrackerBotProximity
+{
+public:
+
+	FTrackerBotProximity();
+
+	void Tick(const FTrackerBotRegistry& Registry, const TArray<APawn*>& Players);
+
+	void Reset();
+
+	// Side of a hash cell, the bots' trigger radius should not exceed it
+	float CellSize;
+
+protected:
+
+	FIntVector GetCell(const FVector& Location) const;
+
+	// Indices into the players array of the players in each cell
+	TMap<FIntVector, TArray<int32>> PlayerCells;
+
+	// Bots and the player that triggered them this tick, triggered after the pass over the registry
+	TArray<TPair<ASTrackerBot*, APawn*>> Triggered;
+};
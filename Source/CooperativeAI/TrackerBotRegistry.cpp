@@ -0,0 +1,80 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TrackerBotRegistry.h"
+#include "STrackerBot.h"
+
+
+FTrackerBotRegistry::FTrackerBotRegistry()
+{
+	Reset();
+}
+
+
+void FTrackerBotRegistry::Register(ASTrackerBot* Bot)
+{
+	if (Bot == nullptr || IsRegistered(Bot))
+	{
+		return;
+	}
+
+	Bot->RegistryIndex = Bots.Add(Bot);
+	StateCounts[(uint8)Bot->RegistryState]++;
+}
+
+
+void FTrackerBotRegistry::Unregister(ASTrackerBot* Bot)
+{
+	if (Bot == nullptr || !IsRegistered(Bot))
+	{
+		return;
+	}
+
+	const int32 Index = Bot->RegistryIndex;
+	StateCounts[(uint8)Bot->RegistryState]--;
+
+	Bots.RemoveAtSwap(Index, 1, false);
+	if (Bots.IsValidIndex(Index))
+	{
+		Bots[Index]->RegistryIndex = Index;
+	}
+
+	Bot->RegistryIndex = INDEX_NONE;
+}
+
+
+void FTrackerBotRegistry::SetState(ASTrackerBot* Bot, ETrackerBotState NewState)
+{
+	if (Bot == nullptr || Bot->RegistryState == NewState)
+	{
+		return;
+	}
+
+	if (IsRegistered(Bot))
+	{
+		StateCounts[(uint8)Bot->RegistryState]--;
+		StateCounts[(uint8)NewState]++;
+	}
+
+	Bot->RegistryState = NewState;
+}
+
+
+void FTrackerBotRegistry::Reset()
+{
+	for (ASTrackerBot* Bot : Bots)
+	{
+		Bot->RegistryIndex = INDEX_NONE;
+	}
+	Bots.Reset();
+
+	for (int32 State = 0; State < (int32)ETrackerBotState::Count; State++)
+	{
+		StateCounts[State] = 0;
+	}
+}
+
+
+bool FTrackerBotRegistry::IsRegistered(const ASTrackerBot* Bot) const
+{
+	return Bots.IsValidIndex(Bot->RegistryIndex) && Bots[Bot->RegistryIndex] == Bot;
+}
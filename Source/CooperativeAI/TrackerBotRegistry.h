@@ -0,0 +1,65 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class ASTrackerBot;
+
+// Life cycle of a tracker bot as seen by the registry
+enum class ETrackerBotState : uint8
+{
+	// Hunting players
+	Alive,
+
+	// Touched a player and is running its self destruct timer
+	Exploding,
+
+	// Exploded and waiting for its life span to end
+	Dead,
+
+	Count,
+};
+
+/**
+ * Live list of the tracker bots of a world.
+ * Bots add themselves on BeginPlay and remove themselves on EndPlay, so the population cap, the swarm and the debug tools
+ * can read the bots and their counts without iterating the world or filling a temporary actor array.
+ */
+class FTrackerBotRegistry
+{
+public:
+
+	FTrackerBotRegistry();
+
+	void Register(ASTrackerBot* Bot);
+
+	// Swaps the last bot into the freed slot, the order of GetBots() is not stable
+	void Unregister(ASTrackerBot* Bot);
+
+	void SetState(ASTrackerBot* Bot, ETrackerBotState NewState);
+
+	// Forgets every bot, used when the world is torn down
+	void Reset();
+
+	const TArray<ASTrackerBot*>& GetBots() const { return Bots; }
+
+	// Every registered bot, including the dead ones that are still in the world
+	int32 Num() const { return Bots.Num(); }
+
+	int32 GetNumInState(ETrackerBotState State) const { return StateCounts[(uint8)State]; }
+
+	int32 GetNumAlive() const { return GetNumInState(ETrackerBotState::Alive); }
+
+	int32 GetNumExploding() const { return GetNumInState(ETrackerBotState::Exploding); }
+
+	int32 GetNumDead() const { return GetNumInState(ETrackerBotState::Dead); }
+
+protected:
+
+	bool IsRegistered(const ASTrackerBot* Bot) const;
+
+	TArray<ASTrackerBot*> Bots;
+
+	int32 StateCounts[(uint8)ETrackerBotState::Count];
+};
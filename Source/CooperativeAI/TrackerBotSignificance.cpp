@@ -0,0 +1,121 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TrackerBotSignificance.h"
+#include "CooperativeAI.h"
+#include "TrackerBotRegistry.h"
+#include "STrackerBot.h"
+
+DECLARE_CYCLE_STAT(TEXT("Significance"), STAT_Significance, STATGROUP_COOP);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Bots Near"), STAT_BotsNear, STATGROUP_COOP);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Bots Mid"), STAT_BotsMid, STATGROUP_COOP);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Bots Far"), STAT_BotsFar, STATGROUP_COOP);
+
+
+FTrackerBotSignificance::FTrackerBotSignificance()
+{
+	FTrackerBotLODSettings& Near = Tiers[(uint8)ETrackerBotLOD::Near];
+	Near.MaxDistance = 2500.0f;
+	Near.MovementInterval = 0.0f;
+	Near.PathRefreshInterval = 5.0f;
+	Near.bDetectPlayers = true;
+	Near.bKinematic = false;
+
+	FTrackerBotLODSettings& Mid = Tiers[(uint8)ETrackerBotLOD::Mid];
+	Mid.MaxDistance = 8000.0f;
+	Mid.MovementInterval = 0.1f;
+	Mid.PathRefreshInterval = 8.0f;
+	Mid.bDetectPlayers = true;
+	Mid.bKinematic = false;
+
+	FTrackerBotLODSettings& Far = Tiers[(uint8)ETrackerBotLOD::Far];
+	Far.MaxDistance = FLT_MAX;
+	Far.MovementInterval = 0.5f;
+	Far.PathRefreshInterval = 15.0f;
+	Far.bDetectPlayers = false;
+	Far.bKinematic = false;
+
+	bForceKinematic = false;
+	Hysteresis = 0.1f;
+	UpdateInterval = 0.25f;
+
+	Reset();
+}
+
+
+void FTrackerBotSignificance::Tick(float DeltaSeconds, const FTrackerBotRegistry& Registry, const TArray<APawn*>& Players)
+{
+	TimeSinceUpdate += DeltaSeconds;
+	if (TimeSinceUpdate < UpdateInterval)
+	{
+		return;
+	}
+	TimeSinceUpdate = 0.0f;
+
+	COOP_SCOPE_CYCLE_COUNTER(STAT_Significance, Significance);
+
+	for (int32 Tier = 0; Tier < (int32)ETrackerBotLOD::Count; Tier++)
+	{
+		TierCounts[Tier] = 0;
+	}
+
+	for (ASTrackerBot* Bot : Registry.GetBots())
+	{
+		ETrackerBotLOD Tier;
+		switch (Bot->GetRegistryState())
+		{
+		case ETrackerBotState::Exploding:
+			// Whatever the distance, a bot about to explode on a player is in combat
+			Tier = ETrackerBotLOD::Near;
+			break;
+		case ETrackerBotState::Dead:
+			Tier = ETrackerBotLOD::Far;
+			break;
+		default:
+		{
+			float NearestDistance = FLT_MAX;
+			for (APawn* Player : Players)
+			{
+				NearestDistance = FMath::Min(NearestDistance, FVector::DistSquared(Player->GetActorLocation(), Bot->GetActorLocation()));
+			}
+			Tier = ComputeTier(Bot->GetLODTier(), FMath::Sqrt(NearestDistance));
+			break;
+		}
+		}
+
+		Bot->SetLODTier(Tier, GetSettings(Tier));
+		Bot->SetKinematic(bForceKinematic || GetSettings(Tier).bKinematic);
+		TierCounts[(uint8)Tier]++;
+	}
+
+	SET_DWORD_STAT(STAT_BotsNear, TierCounts[(uint8)ETrackerBotLOD::Near]);
+	SET_DWORD_STAT(STAT_BotsMid, TierCounts[(uint8)ETrackerBotLOD::Mid]);
+	SET_DWORD_STAT(STAT_BotsFar, TierCounts[(uint8)ETrackerBotLOD::Far]);
+}
+
+
+void FTrackerBotSignificance::Reset()
+{
+	TimeSinceUpdate = 0.0f;
+
+	for (int32 Tier = 0; Tier < (int32)ETrackerBotLOD::Count; Tier++)
+	{
+		TierCounts[Tier] = 0;
+	}
+}
+
+
+ETrackerBotLOD FTrackerBotSignificance::ComputeTier(ETrackerBotLOD CurrentTier, float Distance) const
+{
+	// Moving out a boundary has to go past it by the hysteresis, moving back in has to come as far inside it
+	int32 Tier = 0;
+	while (Tier < (int32)ETrackerBotLOD::Count - 1)
+	{
+		const float Margin = (int32)CurrentTier > Tier ? 1.0f - Hysteresis : 1.0f + Hysteresis;
+		if (Distance <= Tiers[Tier].MaxDistance * Margin)
+		{
+			break;
+		}
+		Tier++;
+	}
+	return (ETrackerBotLOD)Tier;
+}
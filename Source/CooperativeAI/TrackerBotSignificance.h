@@ -0,0 +1,78 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class APawn;
+class FTrackerBotRegistry;
+
+// How much attention a tracker bot gets, from closest to the players to furthest
+enum class ETrackerBotLOD : uint8
+{
+	Near,
+
+	Mid,
+
+	Far,
+
+	Count,
+};
+
+// What a bot of one LOD tier costs
+struct FTrackerBotLODSettings
+{
+	// Furthest distance to a player for the tier, ignored on the last tier
+	float MaxDistance;
+
+	// Seconds between two steering updates of the movement manager, 0 steers every frame. Movement is applied as an impulse covering the whole interval
+	float MovementInterval;
+
+	// Seconds between two path refreshes of a bot that has not reached its next path point
+	float PathRefreshInterval;
+
+	// Whether the proximity pass looks for players around the bot
+	bool bDetectPlayers;
+
+	// Moved by the kinematic integrator instead of a simulated rigid body
+	bool bKinematic;
+};
+
+/**
+ * Sorts the tracker bots into LOD tiers by their distance to the nearest player and their combat state.
+ * A bot changes tier only once it is past the boundary by the hysteresis fraction, so bots moving along a boundary do not flip back and forth.
+ */
+class FTrackerBotSignificance
+{
+public:
+
+	FTrackerBotSignificance();
+
+	// Re-evaluates every bot once per UpdateInterval
+	void Tick(float DeltaSeconds, const FTrackerBotRegistry& Registry, const TArray<APawn*>& Players);
+
+	void Reset();
+
+	const FTrackerBotLODSettings& GetSettings(ETrackerBotLOD Tier) const { return Tiers[(uint8)Tier]; }
+
+	// Bots in the tier at the last evaluation
+	int32 GetNumInTier(ETrackerBotLOD Tier) const { return TierCounts[(uint8)Tier]; }
+
+	FTrackerBotLODSettings Tiers[(uint8)ETrackerBotLOD::Count];
+
+	// Every tier moves kinematically, for large crowd waves
+	bool bForceKinematic;
+
+	// Fraction of a tier boundary a bot has to go past before it changes tier
+	float Hysteresis;
+
+	float UpdateInterval;
+
+protected:
+
+	ETrackerBotLOD ComputeTier(ETrackerBotLOD CurrentTier, float Distance) const;
+
+	float TimeSinceUpdate;
+
+	int32 TierCounts[(uint8)ETrackerBotLOD::Count];
+};
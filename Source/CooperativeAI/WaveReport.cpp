@@ -0,0 +1,109 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "WaveReport.h"
+#include "CooperativeAI.h"
+#include "Misc/Paths.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFilemanager.h"
+
+
+FWaveReport::FWaveReport()
+{
+	Reset();
+}
+
+
+void FWaveReport::BeginWave(int32 InWaveNumber)
+{
+	WaveNumber = InWaveNumber;
+	FrameTimes.Reset();
+	PeakBots = 0;
+	FCoopScopeTimes::Reset();
+	bRecording = true;
+}
+
+
+void FWaveReport::AddFrame(float DeltaSeconds, int32 NumBots)
+{
+	if (bRecording)
+	{
+		FrameTimes.Add(DeltaSeconds * 1000.0f);
+		PeakBots = FMath::Max(PeakBots, NumBots);
+	}
+}
+
+
+void FWaveReport::EndWave(int32 NumPathQueries, int32 NumPathCacheHits)
+{
+	if (!bRecording)
+	{
+		return;
+	}
+	bRecording = false;
+
+	TArray<float> SortedFrameTimes = FrameTimes;
+	SortedFrameTimes.Sort();
+
+	float WaveSeconds = 0.0f;
+	for (float FrameTime : FrameTimes)
+	{
+		WaveSeconds += FrameTime / 1000.0f;
+	}
+
+	const bool bNewFile = FileName.IsEmpty();
+	if (bNewFile)
+	{
+		FileName = FPaths::ProjectSavedDir() / TEXT("Reports") / FString::Printf(TEXT("Waves-%s.csv"), *FDateTime::Now().ToString());
+		FPlatformFileManager::Get().GetPlatformFile().CreateDirectoryTree(*FPaths::GetPath(FileName));
+	}
+
+	FString Report;
+	if (bNewFile)
+	{
+		Report += TEXT("Wave,Frames,Seconds,PeakBots,PathQueries,PathQueriesPerSecond,PathCacheHits,P50Ms,P95Ms,P99Ms,MaxMs");
+		for (int32 Scope = 0; Scope < (int32)ECoopScope::Count; Scope++)
+		{
+			Report += FString::Printf(TEXT(",%sMs,%sCalls"), FCoopScopeTimes::GetName((ECoopScope)Scope), FCoopScopeTimes::GetName((ECoopScope)Scope));
+		}
+		Report += LINE_TERMINATOR;
+	}
+
+	Report += FString::Printf(TEXT("%d,%d,%.2f,%d,%d,%.2f,%d,%.3f,%.3f,%.3f,%.3f"), WaveNumber, FrameTimes.Num(), WaveSeconds, PeakBots, NumPathQueries,
+		WaveSeconds > 0.0f ? NumPathQueries / WaveSeconds : 0.0f, NumPathCacheHits,
+		GetPercentile(SortedFrameTimes, 0.5f), GetPercentile(SortedFrameTimes, 0.95f), GetPercentile(SortedFrameTimes, 0.99f),
+		SortedFrameTimes.Num() > 0 ? SortedFrameTimes.Last() : 0.0f);
+	for (int32 Scope = 0; Scope < (int32)ECoopScope::Count; Scope++)
+	{
+		Report += FString::Printf(TEXT(",%.3f,%u"), FPlatformTime::ToMilliseconds64(FCoopScopeTimes::Cycles[Scope]), FCoopScopeTimes::Calls[Scope]);
+	}
+	Report += LINE_TERMINATOR;
+
+	FFileHelper::SaveStringToFile(Report, *FileName, FFileHelper::EEncodingOptions::ForceAnsi, &IFileManager::Get(), FILEWRITE_Append);
+
+	UE_LOG(LogTemp, Log, TEXT("Wave %d: %d frames, p50 %.2f ms, p95 %.2f ms, p99 %.2f ms"), WaveNumber, FrameTimes.Num(),
+		GetPercentile(SortedFrameTimes, 0.5f), GetPercentile(SortedFrameTimes, 0.95f), GetPercentile(SortedFrameTimes, 0.99f));
+}
+
+
+void FWaveReport::Reset()
+{
+	FrameTimes.Reset();
+	PeakBots = 0;
+	WaveNumber = 0;
+	bRecording = false;
+	FileName.Empty();
+}
+
+
+float FWaveReport::GetPercentile(const TArray<float>& SortedFrameTimes, float Percentile) const
+{
+	if (SortedFrameTimes.Num() == 0)
+	{
+		return 0.0f;
+	}
+
+	const int32 Rank = FMath::CeilToInt(Percentile * SortedFrameTimes.Num());
+	return SortedFrameTimes[FMath::Clamp(Rank - 1, 0, SortedFrameTimes.Num() - 1)];
+}
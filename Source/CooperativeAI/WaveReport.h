@@ -0,0 +1,45 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Frame times of a wave and the game thread time of each COOP scope, written as one CSV row per wave.
+ * A wave is recorded from its start to the start of the next one or the end of the game, spawning and the fight after it alike.
+ * Rows of a match go to Saved/Reports/Waves-<match start>.csv so hitches can be matched with the wave they happened in.
+ */
+class FWaveReport
+{
+public:
+
+	FWaveReport();
+
+	void BeginWave(int32 InWaveNumber);
+
+	// Only recorded between BeginWave and EndWave, NumBots is the number alive this frame
+	void AddFrame(float DeltaSeconds, int32 NumBots);
+
+	// Writes the wave's row, NumPathQueries and NumPathCacheHits are the wave's totals
+	void EndWave(int32 NumPathQueries, int32 NumPathCacheHits);
+
+	void Reset();
+
+	bool IsRecording() const { return bRecording; }
+
+protected:
+
+	// Nearest rank percentile of the sorted frame times, in milliseconds
+	float GetPercentile(const TArray<float>& SortedFrameTimes, float Percentile) const;
+
+	TArray<float> FrameTimes;
+
+	// Most bots alive in a frame of the wave
+	int32 PeakBots;
+
+	int32 WaveNumber;
+
+	bool bRecording;
+
+	FString FileName;
+};